@@ -0,0 +1,137 @@
+#ifndef DUKCPP_ARRAY_OUTPUT_H
+#define DUKCPP_ARRAY_OUTPUT_H
+
+#include <duk/handle.h>
+#include <duk/safe_handle.h>
+#include <duk/scoped_pop.h>
+#include <duk/type_traits_helpers.h>
+#include <duktape.h>
+#include <cstddef>
+#include <ranges>
+#include <utility>
+
+
+namespace duk
+{
+
+
+// Output iterator writing consecutive elements of an ES array, so C++ algorithms (std::ranges::copy, std::transform,
+// etc.) can target ES arrays directly.
+//
+// auto out = duk::array_output_iterator<int>(ctx, -1);
+// std::ranges::copy(values, out);
+template<typename T, handle_type Handle = handle>
+class array_output_iterator final
+{
+public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = void;
+  using pointer = void;
+  using reference = void;
+  using iterator_category = std::output_iterator_tag;
+
+  array_output_iterator() = default;
+
+  // Appends to the array at objIdx.
+  array_output_iterator(duk_context* ctx, duk_idx_t objIdx) :
+    arrayHandle_(handle(ctx, objIdx)),
+    arrayIdx_(static_cast<duk_uarridx_t>(duk_get_length(ctx, objIdx)))
+  {
+  }
+
+  array_output_iterator(const Handle& arrayHandle, duk_uarridx_t arrayIdx) noexcept :
+    arrayHandle_(arrayHandle),
+    arrayIdx_(arrayIdx)
+  {
+  }
+
+  array_output_iterator& operator=(const T& value)
+  {
+    write(value);
+
+    return *this;
+  }
+
+  array_output_iterator& operator=(T&& value)
+  {
+    write(std::move(value));
+
+    return *this;
+  }
+
+  [[nodiscard]]
+  array_output_iterator& operator*() noexcept
+  {
+    return *this;
+  }
+
+  array_output_iterator& operator++() noexcept
+  {
+    ++arrayIdx_;
+
+    return *this;
+  }
+
+  array_output_iterator operator++(int) noexcept
+  {
+    auto copy = *this;
+
+    operator++();
+
+    return copy;
+  }
+
+  // Index of the next written element.
+  [[nodiscard]]
+  duk_uarridx_t index() const noexcept
+  {
+    return arrayIdx_;
+  }
+
+private:
+  void write(auto&& value)
+  {
+    auto ctx = arrayHandle_.ctx();
+
+    scoped_pop _(ctx); // push_handle
+    push_handle(arrayHandle_);
+
+    push(ctx, std::forward<decltype(value)>(value));
+    duk_put_prop_index(ctx, -2, arrayIdx_);
+  }
+
+  Handle arrayHandle_;
+  duk_uarridx_t arrayIdx_ = 0;
+};
+
+
+template<typename T>
+using safe_array_output_iterator = array_output_iterator<T, safe_handle>;
+
+
+// Pushes a new ES array with elements of range.
+//
+// Unlike writing through array_output_iterator, the array stays on the value stack for the whole loop, so each element
+// costs a single push. Elements are written in index order, which keeps them in the dense array part.
+template<std::ranges::input_range Range>
+void push_range(duk_context* ctx, Range&& range)
+{
+  // Array and an element being written.
+  duk_require_stack(ctx, 2);
+
+  duk_push_array(ctx);
+
+  duk_uarridx_t arrayIdx = 0;
+
+  for (auto&& value : range)
+  {
+    push(ctx, std::forward<decltype(value)>(value));
+    duk_put_prop_index(ctx, -2, arrayIdx++);
+  }
+}
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_ARRAY_OUTPUT_H
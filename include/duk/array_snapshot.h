@@ -0,0 +1,143 @@
+#ifndef DUKCPP_ARRAY_SNAPSHOT_H
+#define DUKCPP_ARRAY_SNAPSHOT_H
+
+#include <duk/error.h>
+#include <duk/scoped_pop.h>
+#include <duk/type_traits_helpers.h>
+#include <duktape.h>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+namespace duk
+{
+
+
+// Copy of ES array elements in contiguous C++ storage, made in a single pass.
+//
+// Unlike array_input_range, which reads the array on every dereference, it's plain memory, so it can be handed to any
+// C++ algorithm. Changes to the snapshot aren't reflected in the array, and vice versa.
+template<typename T>
+class array_snapshot final
+{
+public:
+  using value_type = T;
+  using iterator = typename std::vector<T>::iterator;
+  using const_iterator = typename std::vector<T>::const_iterator;
+
+  array_snapshot() = default;
+
+  // Throws if value at idx isn't an array, or if any of its elements can't be converted to T.
+  array_snapshot(duk_context* ctx, duk_idx_t idx)
+  {
+    if (!duk_is_array(ctx, idx)) [[unlikely]]
+      throw error(ctx, "array expected");
+
+    idx = duk_normalize_index(ctx, idx);
+
+    auto length = static_cast<duk_uarridx_t>(duk_get_length(ctx, idx));
+
+    values_.reserve(length);
+
+    // Elements are read in chunks, so every chunk gets popped at once, and stack space is reserved only once.
+    static constexpr duk_uarridx_t chunkSize = 256;
+
+    duk_require_stack(ctx, static_cast<duk_idx_t>(std::min(chunkSize, length)));
+
+    for (duk_uarridx_t first = 0; first < length; first += chunkSize)
+    {
+      auto count = std::min(chunkSize, length - first);
+
+      for (duk_uarridx_t i = 0; i < count; ++i)
+        duk_get_prop_index(ctx, idx, first + i);
+
+      scoped_pop _(ctx, static_cast<duk_idx_t>(count)); // duk_get_prop_index
+
+      for (auto elementIdx = -static_cast<duk_idx_t>(count); elementIdx < 0; ++elementIdx)
+      {
+        if (!check_type<T>(ctx, elementIdx)) [[unlikely]]
+          throw error(ctx, "unexpected array element type");
+
+        values_.emplace_back(get<T>(ctx, elementIdx));
+      }
+    }
+  }
+
+  [[nodiscard]]
+  T* data() noexcept
+  {
+    return values_.data();
+  }
+
+  [[nodiscard]]
+  const T* data() const noexcept
+  {
+    return values_.data();
+  }
+
+  [[nodiscard]]
+  std::size_t size() const noexcept
+  {
+    return values_.size();
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  [[nodiscard]]
+  T& operator[](std::size_t pos) noexcept
+  {
+    return values_[pos];
+  }
+
+  [[nodiscard]]
+  const T& operator[](std::size_t pos) const noexcept
+  {
+    return values_[pos];
+  }
+
+  [[nodiscard]]
+  iterator begin() noexcept
+  {
+    return values_.begin();
+  }
+
+  [[nodiscard]]
+  const_iterator begin() const noexcept
+  {
+    return values_.begin();
+  }
+
+  [[nodiscard]]
+  iterator end() noexcept
+  {
+    return values_.end();
+  }
+
+  [[nodiscard]]
+  const_iterator end() const noexcept
+  {
+    return values_.end();
+  }
+
+  // Gives up ownership of copied elements.
+  [[nodiscard]]
+  std::vector<T> release() noexcept
+  {
+    return std::move(values_);
+  }
+
+private:
+  std::vector<T> values_;
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_ARRAY_SNAPSHOT_H
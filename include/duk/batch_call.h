@@ -0,0 +1,141 @@
+#ifndef DUKCPP_BATCH_CALL_H
+#define DUKCPP_BATCH_CALL_H
+
+#include <duk/error.h>
+#include <duk/function_handle.h>
+#include <duk/handle.h>
+#include <duk/scoped_pop.h>
+#include <duk/type_traits_helpers.h>
+#include <duktape.h>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+
+namespace duk
+{
+
+
+namespace detail
+{
+
+
+// Calls function pointed by handle for each element of range, and passes each result (at the top of the stack) to
+// onResult. All calls run within a single protected call, and reuse the same value stack slots. The first error ends
+// the loop: ES errors get thrown as es_error, while C++ exceptions derived from std::exception (e.g. thrown by onResult)
+// are rethrown as they are. Number of completed calls is stored in completed (if not null) before anything is thrown.
+void batch_call(const handle_type auto& handle, auto&& range, auto&& onResult, std::size_t* completed)
+{
+  using Range = decltype(range);
+  using OnResult = decltype(onResult);
+
+  struct Batch
+  {
+    Range range;
+    OnResult onResult;
+    std::size_t completed = 0;
+    std::exception_ptr exception;
+  };
+
+  static constexpr auto run = [](duk_context* ctx, void* udata) -> duk_ret_t
+  {
+    auto& batch = *static_cast<Batch*>(udata);
+
+    // C++ exceptions are taken out of the protected call, which would turn them into ES errors. Duktape's own errors
+    // don't derive from std::exception, so they still unwind to duk_safe_call.
+    try
+    {
+      for (auto&& element : batch.range)
+      {
+        duk_dup(ctx, 0);
+        push(ctx, std::forward<decltype(element)>(element));
+        duk_call(ctx, 1);
+
+        batch.onResult(ctx);
+
+        duk_pop(ctx); // Pop result
+
+        ++batch.completed;
+      }
+    }
+    catch (const std::exception&)
+    {
+      batch.exception = std::current_exception();
+    }
+
+    return 0;
+  };
+
+  auto ctx = handle.ctx();
+
+  auto batch = Batch{ std::forward<Range>(range), std::forward<OnResult>(onResult) };
+
+  push_handle(handle);
+
+  scoped_pop _(ctx); // duk_safe_call
+  auto result = duk_safe_call(ctx, run, &batch, 1, 1);
+
+  if (completed)
+    *completed = batch.completed;
+
+  if (result != DUK_EXEC_SUCCESS)
+    throw duk::es_error(ctx, -1);
+
+  if (batch.exception)
+    std::rethrow_exception(batch.exception);
+}
+
+
+} // namespace detail
+
+
+// Calls fn for each element of range. See map_call.
+template<typename Result, typename Handle>
+void for_each_call(
+  const function_handle<Result, Handle>& fn,
+  std::ranges::input_range auto&& range,
+  std::size_t* completed = nullptr
+)
+{
+  detail::batch_call(fn.get(), std::forward<decltype(range)>(range), []([[maybe_unused]] duk_context* ctx) {},
+    completed
+  );
+}
+
+
+// Calls fn for each element of range, and writes results to out. Compared to calling fn in a loop, the whole batch
+// runs within a single protected call, and reuses value stack slots. The first error ends the batch: ES errors
+// (including a result of unexpected type) get thrown as es_error, and C++ exceptions derived from std::exception (e.g.
+// thrown by the output iterator) keep their type. Results written so far stay in the output, and their count is stored in completed (if not
+// null), whether the batch completes or not.
+template<typename Result, typename Handle, typename Output>
+requires (!std::is_void_v<Result>)
+Output map_call(
+  const function_handle<Result, Handle>& fn,
+  std::ranges::input_range auto&& range,
+  Output out,
+  std::size_t* completed = nullptr
+)
+{
+  detail::batch_call(fn.get(), std::forward<decltype(range)>(range),
+    [&out](duk_context* ctx)
+    {
+      if (!check_type<Result>(ctx, -1)) [[unlikely]]
+        (void)duk_error(ctx, DUK_ERR_TYPE_ERROR, "unexpected result type");
+
+      *out++ = get<Result>(ctx, -1);
+    },
+    completed
+  );
+
+  return out;
+}
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_BATCH_CALL_H
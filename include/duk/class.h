@@ -1,7 +1,12 @@
 #ifndef DUKCPP_CLASS_H
 #define DUKCPP_CLASS_H
 
+#include <duk/common.h>
+#include <duk/error.h>
+#include <duk/scoped_pop.h>
+#include <duk/type_traits_helpers.h>
 #include <duktape.h>
+#include <type_traits>
 #include <utility>
 
 
@@ -11,6 +16,7 @@ namespace duk
 
 // class_traits_prototype
 
+// Specializing this trait overrides the prototype registry (see register_prototype) for a given type.
 template<typename T>
 struct class_traits_prototype;
 
@@ -44,6 +50,94 @@ template<typename T>
 using class_traits_base_t = typename class_traits_base<T>::type;
 
 
+// class_traits_inline_storage
+
+// By default, C++ objects are allocated separately and their wrappers only keep a pointer to them. Types specializing
+// this trait as std::true_type are constructed in place, inside a Duktape fixed buffer referenced by the wrapper, so
+// their memory is owned (and accounted for) by Duktape's garbage collector, and finalization only runs the destructor.
+//
+// It doesn't save an allocation, or the lookup reaching the object: Duktape objects have no internal slots, so the
+// buffer is a heap object of its own, referenced by the same hidden property the pointer would be. Buffer data is
+// aligned to 8 bytes only by Duktape builds with DUK_USE_ALIGN_BY == 8, so objects whose buffer turns out misaligned
+// for them are allocated separately instead.
+template<typename T>
+struct class_traits_inline_storage : std::false_type
+{
+};
+
+
+template<typename T>
+concept has_class_traits_inline_storage = class_traits_inline_storage<T>::value;
+
+
+// class_traits_mirror
+
+// Data members listed by this trait (as duk::mirror<duk::mirrored<"name", &T::member>...>) are materialized as plain
+// own data properties of every pushed object, so script reads don't cross the C boundary at all. Writes only change
+// the ES side, and need to be copied back with duk::sync. C++ side changes are published with duk::refresh. Mirrored
+// properties shadow prototype accessors of the same name.
+template<typename T>
+struct class_traits_mirror;
+
+
+template<typename T>
+concept has_class_traits_mirror = requires
+{
+  typename class_traits_mirror<T>::type;
+};
+
+
+template<typename T>
+using class_traits_mirror_t = typename class_traits_mirror<T>::type;
+
+
+template<fixed_string Name, auto MemberPtr>
+struct mirrored
+{
+  static void push(duk_context* ctx, duk_idx_t idx, const auto& obj)
+  {
+    // Defined rather than put, so prototype accessors of the same name don't intercept it.
+    duk::push(ctx, std::string_view(Name));
+    duk::push(ctx, obj.*MemberPtr);
+    duk_def_prop(ctx, idx,
+      DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_SET_WRITABLE | DUK_DEFPROP_SET_ENUMERABLE | DUK_DEFPROP_SET_CONFIGURABLE
+    );
+  }
+
+  static void sync(duk_context* ctx, duk_idx_t idx, auto& obj)
+  {
+    using ValueT = std::remove_cvref_t<decltype(obj.*MemberPtr)>;
+
+    scoped_pop _(ctx); // get_prop_string
+    detail::get_prop_string(ctx, idx, Name);
+
+    if (!check_type<ValueT>(ctx, -1)) [[unlikely]]
+      throw error(ctx, "invalid mirrored property value");
+
+    obj.*MemberPtr = get<ValueT>(ctx, -1);
+  }
+};
+
+
+template<typename ...Mirrored>
+struct mirror
+{
+  static void push(duk_context* ctx, duk_idx_t idx, const auto& obj)
+  {
+    idx = duk_normalize_index(ctx, idx);
+
+    (Mirrored::push(ctx, idx, obj), ...);
+  }
+
+  static void sync(duk_context* ctx, duk_idx_t idx, auto& obj)
+  {
+    idx = duk_normalize_index(ctx, idx);
+
+    (Mirrored::sync(ctx, idx, obj), ...);
+  }
+};
+
+
 // ctor
 
 template<typename T>
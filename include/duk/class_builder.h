@@ -0,0 +1,213 @@
+#ifndef DUKCPP_CLASS_BUILDER_H
+#define DUKCPP_CLASS_BUILDER_H
+
+#include <duk/class.h>
+#include <duk/common.h>
+#include <duk/error.h>
+#include <duk/function_helpers.h>
+#include <duk/iterable.h>
+#include <duk/property_helpers.h>
+#include <duk/prototype_helpers.h>
+#include <duktape.h>
+#include <string_view>
+#include <type_traits>
+
+
+namespace duk
+{
+
+
+// Class members, used as duk::class_ template parameters.
+//
+// Each of them defines itself with def(), which is called with class constructor and prototype at the top of the
+// value stack (in that order).
+
+// Constructor overloads (e.g. duk::ctor<T, Args...>). Constructor-less classes are represented by plain objects.
+template<auto ...Ctor>
+struct constructor
+{
+  static duk_idx_t push(duk_context* ctx)
+  {
+    return push_function<Ctor...>(ctx);
+  }
+
+  static void def([[maybe_unused]] duk_context* ctx)
+  {
+  }
+};
+
+
+// Prototype method. Accepts both member function pointers and free functions taking `this` as the first argument.
+template<fixed_string Name, auto ...Func>
+struct method
+{
+  static void def(duk_context* ctx)
+  {
+    put_prop_method<Func...>(ctx, -1, Name);
+  }
+};
+
+
+// Function defined on the constructor (e.g. factory functions).
+template<fixed_string Name, auto ...Func>
+struct static_method
+{
+  static void def(duk_context* ctx)
+  {
+    put_prop_function<Func...>(ctx, -2, Name);
+  }
+};
+
+
+// Prototype property backed by a data member.
+template<fixed_string Name, auto MemberPtr, duk_uint_t Flags = 0>
+struct property
+{
+  static void def(duk_context* ctx)
+  {
+    def_prop<MemberPtr>(ctx, -1, Name, Flags);
+  }
+};
+
+
+// Prototype property backed by getter and setter methods.
+template<fixed_string Name, auto GetterPtr, auto SetterPtr, duk_uint_t Flags = 0>
+struct property_method
+{
+  static void def(duk_context* ctx)
+  {
+    def_prop_method<GetterPtr, SetterPtr>(ctx, -1, Name, Flags);
+  }
+};
+
+
+// Base class. Its prototype needs to be registered first (see register_prototype), and it needs to match
+// class_traits_base, which describes the same relation in C++.
+template<typename Base>
+struct base
+{
+  static void def(duk_context* ctx)
+  {
+    auto heapPtr = get_prototype<Base>(ctx);
+    if (!heapPtr) [[unlikely]]
+      throw error(ctx, "base class prototype not registered");
+
+    duk_push_heapptr(ctx, heapPtr);
+    duk_set_prototype(ctx, -2);
+  }
+};
+
+
+namespace detail
+{
+
+
+template<typename Member>
+struct is_class_constructor : std::false_type
+{
+};
+
+template<auto ...Ctor>
+struct is_class_constructor<constructor<Ctor...>> : std::true_type
+{
+};
+
+
+template<typename Member>
+struct is_class_base : std::false_type
+{
+};
+
+template<typename Base>
+struct is_class_base<base<Base>> : std::true_type
+{
+};
+
+
+template<typename T, typename Member>
+inline constexpr bool class_base_matches = true;
+
+template<typename T, typename Base>
+inline constexpr bool class_base_matches<T, base<Base>> = std::is_same_v<class_traits_base_t<T>, Base>;
+
+
+} // namespace detail
+
+
+// Declarative class binding.
+//
+// using VectorClass = duk::class_<Vector,
+//   duk::constructor<duk::ctor<Vector>, duk::ctor<Vector, float, float>>,
+//   duk::method<"length", &Vector::length>,
+//   duk::property<"x", &Vector::x>
+// >;
+//
+// VectorClass::put_prop(ctx, -1, "Vector");
+//
+// Constructor and prototype are built in a single pass, and compacted once all members are defined, so they don't
+// waste memory on spare property slots. That includes Symbol.iterator which pushed objects inherit.
+// Prototype gets registered for T (see register_prototype).
+template<typename T, typename ...Member>
+struct class_ final
+{
+  static constexpr std::size_t constructorCount =
+    (std::size_t(detail::is_class_constructor<Member>::value) + ... + 0);
+
+  static constexpr std::size_t baseCount =
+    (std::size_t(detail::is_class_base<Member>::value) + ... + 0);
+
+  static_assert(constructorCount <= 1, "class can have at most one constructor member (list overloads within it)");
+  static_assert(baseCount <= 1, "class can have at most one base");
+  static_assert((detail::class_base_matches<T, Member> && ...), "base doesn't match class_traits_base");
+
+  // Pushes constructor (or a plain object, if class has no constructor) with prototype property set.
+  static duk_idx_t push(duk_context* ctx)
+  {
+    duk_idx_t idx;
+
+    if constexpr (constructorCount != 0)
+    {
+      (
+        [ctx, &idx]()
+        {
+          if constexpr (detail::is_class_constructor<Member>::value)
+            idx = Member::push(ctx);
+        }(),
+        ...
+      );
+    }
+    else
+    {
+      idx = duk_push_object(ctx);
+    }
+
+    duk_push_object(ctx); // prototype
+
+    register_prototype<T>(ctx, -1);
+
+    (Member::def(ctx), ...);
+
+    // Prototype would otherwise get it on first push, undoing compaction (see make_prototype_iterable).
+    if constexpr (iterable<T>)
+      detail::make_prototype_iterable<T>(ctx, duk_get_heapptr(ctx, -1), type_id<T>());
+
+    duk_compact(ctx, -1);
+    duk_put_prop_literal(ctx, -2, "prototype");
+
+    duk_compact(ctx, -1);
+
+    return idx;
+  }
+
+  static void put_prop(duk_context* ctx, duk_idx_t idx, std::string_view name)
+  {
+    push(ctx);
+    duk_put_prop_lstring(ctx, idx - 1, name.data(), name.length());
+  }
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_CLASS_BUILDER_H
@@ -6,6 +6,9 @@
 #include <duk/fwd.h>
 #include <boost/callable_traits.hpp>
 #include <duktape.h>
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
 #include <utility>
 
 
@@ -48,6 +51,25 @@ concept object = requires
 };
 
 
+// String usable as a non-type template parameter (e.g. duk::method<"name", ...>).
+template<std::size_t N>
+struct fixed_string
+{
+  constexpr fixed_string(const char (&str)[N]) noexcept
+  {
+    std::copy_n(str, N, data);
+  }
+
+  [[nodiscard]]
+  constexpr operator std::string_view() const noexcept
+  {
+    return { data, N - 1 };
+  }
+
+  char data[N];
+};
+
+
 namespace detail
 {
 
@@ -1,6 +1,7 @@
 #ifndef DUKCPP_CONTEXT_H
 #define DUKCPP_CONTEXT_H
 
+#include <duk/detail/heap_state.h>
 #include <duktape.h>
 #include <memory>
 
@@ -12,9 +13,13 @@ namespace duk
 class context final
 {
 public:
-  context(duk_context* ctx) noexcept :
+  // Heap state is created right away, so built-ins it captures can't have been replaced by script code yet (see
+  // is_array_iterator).
+  context(duk_context* ctx) :
     ctx_(ctx)
   {
+    if (ctx)
+      (void)detail::get_heap_state(ctx);
   }
 
   operator duk_context*() const noexcept
@@ -32,6 +37,11 @@ private:
   {
     void operator()(duk_context* ctx) const noexcept
     {
+      // Objects released by other threads are still pinned, so they're released first, and get finalized like any other
+      // unreachable object. Heaps which never used dukcpp state have nothing to release.
+      if (auto heapState = detail::find_heap_state(ctx))
+        detail::drain_releases(ctx, *heapState);
+
       duk_destroy_heap(ctx);
     }
   };
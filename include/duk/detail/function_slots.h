@@ -0,0 +1,119 @@
+#ifndef DUKCPP_DETAIL_FUNCTION_SLOTS_H
+#define DUKCPP_DETAIL_FUNCTION_SLOTS_H
+
+#include <duk/detail/heap_state.h>
+#include <duktape.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace duk::detail
+{
+
+
+// Functors of stateful callables are kept in a per-heap table (see HeapState::functionSlots), indexed by magic of their
+// native functions, so a call finds its functor with a single read instead of a property lookup on the current
+// function.
+//
+// Magic is only 16 bits wide, so each heap has up to 65535 slots. Once every slot is taken, callables fall back to
+// their hidden property (see type_traits<callable>).
+static constexpr std::size_t no_function_slot = 0;
+static constexpr std::size_t max_function_slots = std::size_t(1) << 16;
+
+
+// Magic is a signed 16-bit value, so upper half of the slots map to negative magic.
+[[nodiscard]]
+inline std::size_t function_slot(duk_int_t magic) noexcept
+{
+  return static_cast<std::uint16_t>(magic);
+}
+
+
+[[nodiscard]]
+inline duk_int_t function_slot_magic(std::size_t slot) noexcept
+{
+  return static_cast<std::int16_t>(static_cast<std::uint16_t>(slot));
+}
+
+
+[[nodiscard]]
+inline FunctionInfo* get_function_slot(const HeapState& heapState, std::size_t slot) noexcept
+{
+  return heapState.functionSlots[slot].funcInfo;
+}
+
+
+// Returns no_function_slot if all slots are taken.
+[[nodiscard]]
+inline std::size_t acquire_function_slot(duk_context* ctx, HeapState& heapState, FunctionInfo* funcInfo)
+{
+  if (heapState.functionFreeSlot == no_function_slot)
+  {
+    if (heapState.functionSlotCount == max_function_slots) [[unlikely]]
+      return no_function_slot;
+
+    // Slot 0 is never used, but it still takes space, so the first slot taken grows the table from nothing.
+    if (heapState.functionSlotCount >= heapState.functionSlotCapacity)
+    {
+      auto newCapacity = std::min(heapState.functionSlotCapacity ? heapState.functionSlotCapacity * 2 : 64,
+        max_function_slots);
+
+      duk_push_heap_stash(ctx);
+
+      auto newSlots = static_cast<HeapState::FunctionSlot*>(
+        duk_push_fixed_buffer(ctx, newCapacity * sizeof(HeapState::FunctionSlot))
+      );
+
+      // Allocation may have run finalizers, which could have grown the buffer already.
+      if (newCapacity > heapState.functionSlotCapacity)
+      {
+        std::copy_n(heapState.functionSlots, heapState.functionSlotCapacity, newSlots);
+
+        duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("functionSlots"));
+
+        heapState.functionSlots = newSlots;
+        heapState.functionSlotCapacity = newCapacity;
+      }
+      else
+      {
+        duk_pop(ctx); // Pop unused buffer
+      }
+
+      duk_pop(ctx); // Pop heap stash
+    }
+  }
+
+  // Finalizers run by the allocation above may have released slots, so the free list is checked again.
+  std::size_t slot;
+
+  if (heapState.functionFreeSlot != no_function_slot)
+  {
+    slot = heapState.functionFreeSlot;
+    heapState.functionFreeSlot = heapState.functionSlots[slot].nextFree;
+  }
+  else
+  {
+    slot = heapState.functionSlotCount++;
+  }
+
+  heapState.functionSlots[slot].funcInfo = funcInfo;
+
+  return slot;
+}
+
+
+inline void release_function_slot(HeapState& heapState, std::size_t slot) noexcept
+{
+  auto& entry = heapState.functionSlots[slot];
+  entry.funcInfo = nullptr;
+  entry.nextFree = heapState.functionFreeSlot;
+
+  heapState.functionFreeSlot = slot;
+}
+
+
+} // namespace duk::detail
+
+
+#endif // DUKCPP_DETAIL_FUNCTION_SLOTS_H
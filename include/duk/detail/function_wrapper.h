@@ -1,9 +1,13 @@
 #ifndef DUKCPP_DETAIL_FUNCTION_WRAPPER_H
 #define DUKCPP_DETAIL_FUNCTION_WRAPPER_H
 
+#include <duk/common.h>
 #include <duk/fwd.h>
 #include <boost/callable_traits.hpp>
 #include <duktape.h>
+#include <algorithm>
+#include <array>
+#include <concepts>
 #include <functional>
 #include <string_view>
 #include <tuple>
@@ -78,6 +82,52 @@ inline static duk_ret_t throwESError(duk_context* ctx, duk_errcode_t errorCode,
 }
 
 
+// Largest argument count (including implicit object argument of method signatures) among given signatures.
+template<typename ...Signature>
+inline constexpr std::size_t max_arg_count_v =
+  std::max({ std::size_t(0), std::tuple_size_v<boost::callable_traits::args_t<Signature>>... });
+
+
+// Caches ObjectInfo pointers of native call arguments, so each object argument's hidden property is looked up at most
+// once per call, no matter how many overloads are tried and whether it's needed by check_type, get or both.
+//
+// Slots are assigned to call arguments as seen by ES: slot 0 holds `this`, slot n holds n-th argument. That way,
+// results can be shared between method signatures (which expect `this` on value stack index 0) and plain function
+// signatures.
+template<std::size_t ArgCount>
+class ObjectInfoCache final
+{
+public:
+  [[nodiscard]]
+  ObjectInfo* get(duk_context* ctx, duk_idx_t idx, std::size_t slot) noexcept
+  {
+    if (!resolved_[slot])
+    {
+      objInfo_[slot] = get_object_info(ctx, idx);
+      resolved_[slot] = true;
+    }
+
+    return objInfo_[slot];
+  }
+
+private:
+  std::array<ObjectInfo*, ArgCount + 1> objInfo_{};
+  std::array<bool, ArgCount + 1> resolved_{};
+};
+
+
+// Duktape types (DUK_TYPE_MASK_*) accepted by type_traits<T>::check_type. Types which don't declare type_mask are
+// assumed to accept values of any type.
+template<typename T>
+inline constexpr duk_uint_t type_mask_v = []
+{
+  if constexpr (requires { { type_traits<T>::type_mask } -> std::convertible_to<duk_uint_t>; })
+    return static_cast<duk_uint_t>(type_traits<T>::type_mask);
+  else
+    return ~duk_uint_t(0);
+}();
+
+
 template<typename Signature, typename ArgIdx, bool IsPropertyCall>
 struct FunctionWrapper;
 
@@ -87,16 +137,26 @@ struct FunctionWrapper<Signature, std::index_sequence<argIdx...>, IsPropertyCall
   using Result = boost::callable_traits::return_type_t<Signature>;
   using ArgsTuple = boost::callable_traits::args_t<Signature>;
 
-  static duk_ret_t run(duk_context* ctx, auto&& func)
+  static constexpr bool isMethodCall = requires { typename boost::callable_traits::class_of_t<Signature>; };
+
+  static constexpr bool pushThis = isMethodCall || IsPropertyCall;
+
+  // Number of arguments passed by the caller (i.e. not counting `this`), and Duktape types each of them may have.
+  static constexpr std::size_t esArgCount = sizeof...(argIdx) - (pushThis ? 1 : 0);
+
+  static constexpr auto esArgTypeMasks = []<std::size_t ...esArgIdx>(std::index_sequence<esArgIdx...>)
   {
-    static constexpr bool isMethodCall = requires { typename boost::callable_traits::class_of_t<Signature>; };
+    return std::array<duk_uint_t, esArgCount>{
+      type_mask_v<std::tuple_element_t<esArgIdx + (pushThis ? 1 : 0), ArgsTuple>>...
+    };
+  }(std::make_index_sequence<esArgCount>());
 
+  static duk_ret_t run(duk_context* ctx, auto&& func, auto& objInfoCache)
+  {
     // Pop property name string so parameter count on the value stack matches function signature.
     if constexpr (IsPropertyCall)
       duk_pop(ctx);
 
-    static constexpr bool pushThis = isMethodCall || IsPropertyCall;
-
     if constexpr (pushThis)
     {
       duk_push_this(ctx);
@@ -104,7 +164,7 @@ struct FunctionWrapper<Signature, std::index_sequence<argIdx...>, IsPropertyCall
     }
 
     bool argsMatch = duk_get_top(ctx) == sizeof...(argIdx) &&
-                     (type_traits<std::tuple_element_t<argIdx, ArgsTuple>>::check_type(ctx, argIdx) && ...);
+                     (checkArg<argIdx>(ctx, objInfoCache) && ...);
     if (!argsMatch)
     {
       if constexpr (pushThis)
@@ -115,18 +175,180 @@ struct FunctionWrapper<Signature, std::index_sequence<argIdx...>, IsPropertyCall
 
     if constexpr (std::is_same_v<Result, void>)
     {
-      std::invoke(func, type_traits<std::tuple_element_t<argIdx, ArgsTuple>>::get(ctx, argIdx)...);
+      std::invoke(func, getArg<argIdx>(ctx, objInfoCache)...);
       return 0;
     }
     else
     {
       type_traits<Result>::push(
         ctx,
-        std::invoke(func, type_traits<std::tuple_element_t<argIdx, ArgsTuple>>::get(ctx, argIdx)...)
+        std::invoke(func, getArg<argIdx>(ctx, objInfoCache)...)
       );
       return 1;
     }
   }
+
+private:
+  template<std::size_t idx>
+  static constexpr std::size_t slot = pushThis ? idx : idx + 1;
+
+  template<std::size_t idx>
+  [[nodiscard]]
+  static bool checkArg(duk_context* ctx, auto& objInfoCache) noexcept
+  {
+    using Arg = std::tuple_element_t<idx, ArgsTuple>;
+
+    if constexpr (object<Arg>)
+      return type_traits<Arg>::check_type(ctx, idx, objInfoCache.get(ctx, idx, slot<idx>));
+    else
+      return type_traits<Arg>::check_type(ctx, idx);
+  }
+
+  template<std::size_t idx>
+  [[nodiscard]]
+  static decltype(auto) getArg(duk_context* ctx, auto& objInfoCache)
+  {
+    using Arg = std::tuple_element_t<idx, ArgsTuple>;
+
+    if constexpr (object<Arg>)
+      return type_traits<Arg>::get(ctx, idx, objInfoCache.get(ctx, idx, slot<idx>));
+    else
+      return type_traits<Arg>::get(ctx, idx);
+  }
+};
+
+
+// Overload candidates calling a function known at compile time (Func) or a callable object (of type Func) passed to
+// OverloadDispatcher::run.
+template<auto Func, typename Signature>
+struct StaticOverloadCandidate
+{
+  using Wrapper = FunctionWrapper<
+    Signature, std::make_index_sequence<std::tuple_size_v<boost::callable_traits::args_t<Signature>>>, false
+  >;
+
+  template<typename ObjectInfoCacheT>
+  static duk_ret_t run(duk_context* ctx, [[maybe_unused]] void* func, ObjectInfoCacheT& objInfoCache)
+  {
+    return Wrapper::run(ctx, Func, objInfoCache);
+  }
+};
+
+
+template<typename Func, typename Signature>
+struct DynamicOverloadCandidate
+{
+  using Wrapper = FunctionWrapper<
+    Signature, std::make_index_sequence<std::tuple_size_v<boost::callable_traits::args_t<Signature>>>, false
+  >;
+
+  template<typename ObjectInfoCacheT>
+  static duk_ret_t run(duk_context* ctx, void* func, ObjectInfoCacheT& objInfoCache)
+  {
+    return Wrapper::run(ctx, *static_cast<Func*>(func), objInfoCache);
+  }
+};
+
+
+// Picks overload matching arguments of a native call.
+//
+// Candidates are grouped by their argument count at compile time, so only the ones matching duk_get_top() are
+// considered. Types of call arguments are read once, and compared against type masks of candidates' parameters.
+// Only candidates passing both tests run the complete check_type chain (which, for objects, requires a property
+// lookup). Candidates are still tried in declaration order, so the first matching overload wins, just like before.
+template<typename ...Candidate>
+class OverloadDispatcher final
+{
+public:
+  static duk_ret_t run(duk_context* ctx, void* func = nullptr)
+  {
+    auto argCount = static_cast<std::size_t>(duk_get_top(ctx));
+    if (argCount > maxEsArgCount)
+      return DUK_RET_TYPE_ERROR;
+
+    std::array<duk_uint_t, maxEsArgCount> argTypeMasks;
+    for (std::size_t i = 0; i < argCount; ++i)
+      argTypeMasks[i] = duk_get_type_mask(ctx, static_cast<duk_idx_t>(i));
+
+    ObjectInfoCacheT objInfoCache;
+
+    for (auto i = first[argCount]; i != first[argCount + 1]; ++i)
+    {
+      const auto& entry = entries[order[i]];
+
+      bool typesMatch = true;
+      for (std::size_t j = 0; j < argCount && typesMatch; ++j)
+        typesMatch = (argTypeMasks[j] & entry.argTypeMasks[j]) != 0;
+
+      if (!typesMatch)
+        continue;
+
+      if (auto result = entry.run(ctx, func, objInfoCache); result >= 0)
+        return result;
+    }
+
+    return DUK_RET_TYPE_ERROR;
+  }
+
+private:
+  using ObjectInfoCacheT = ObjectInfoCache<
+    std::max({ std::size_t(0), std::tuple_size_v<typename Candidate::Wrapper::ArgsTuple>... })
+  >;
+
+  static constexpr std::size_t maxEsArgCount = std::max({ std::size_t(0), Candidate::Wrapper::esArgCount... });
+
+  struct Entry
+  {
+    std::size_t argCount;
+    const duk_uint_t* argTypeMasks;
+    duk_ret_t (*run)(duk_context*, void*, ObjectInfoCacheT&);
+  };
+
+  static constexpr std::array<Entry, sizeof...(Candidate)> entries{{
+    {
+      Candidate::Wrapper::esArgCount,
+      Candidate::Wrapper::esArgTypeMasks.data(),
+      &Candidate::template run<ObjectInfoCacheT>
+    }...
+  }};
+
+  // Indices of entries, stably sorted by argument count.
+  static constexpr auto order = []
+  {
+    std::array<std::size_t, sizeof...(Candidate)> order{};
+    std::size_t pos = 0;
+
+    for (std::size_t argCount = 0; argCount <= maxEsArgCount; ++argCount)
+      for (std::size_t i = 0; i < entries.size(); ++i)
+        if (entries[i].argCount == argCount)
+          order[pos++] = i;
+
+    return order;
+  }();
+
+  // Candidates taking n arguments are order[first[n]]...order[first[n + 1] - 1].
+  static constexpr auto first = []
+  {
+    std::array<std::size_t, maxEsArgCount + 2> first{};
+
+    for (const auto& entry : entries)
+      ++first[entry.argCount + 1];
+
+    for (std::size_t argCount = 1; argCount < first.size(); ++argCount)
+      first[argCount] += first[argCount - 1];
+
+    return first;
+  }();
+};
+
+
+template<typename CandidateTuple>
+struct overload_dispatcher;
+
+template<typename ...Candidate>
+struct overload_dispatcher<std::tuple<Candidate...>>
+{
+  using type = OverloadDispatcher<Candidate...>;
 };
 
 
@@ -137,8 +359,12 @@ struct FunctionSignatureWrapper;
 template<auto Func, bool IsPropertyCall, typename ...Signature>
 struct FunctionSignatureWrapper<function_descriptor<Func, Signature...>, IsPropertyCall>
 {
+  using Candidates = std::tuple<StaticOverloadCandidate<Func, Signature>...>;
+
   static duk_ret_t run(duk_context* ctx)
   {
+    ObjectInfoCache<max_arg_count_v<Signature...>> objInfoCache;
+
     duk_ret_t result;
     
     (void)(((result =
@@ -148,7 +374,9 @@ struct FunctionSignatureWrapper<function_descriptor<Func, Signature...>, IsPrope
 
         static constexpr auto argCount = std::tuple_size_v<ArgsTuple>;
 
-        return detail::FunctionWrapper<Signature, std::make_index_sequence<argCount>, IsPropertyCall>::run(ctx, Func);
+        return detail::FunctionWrapper<
+          Signature, std::make_index_sequence<argCount>, IsPropertyCall
+        >::run(ctx, Func, objInfoCache);
       }()) < 0) && ...);
 
     return result;
@@ -160,9 +388,13 @@ struct FunctionSignatureWrapper<function_descriptor<Func, Signature...>, IsPrope
 template<typename ...FuncDesc>
 duk_ret_t overloadedFunctionWrapper(duk_context* ctx)
 {
-  duk_ret_t result;
+  using Dispatcher = typename overload_dispatcher<
+    decltype(std::tuple_cat(std::declval<typename FunctionSignatureWrapper<FuncDesc>::Candidates>()...))
+  >::type;
+
+  duk_ret_t result = Dispatcher::run(ctx);
 
-  if ((((result = FunctionSignatureWrapper<FuncDesc>::run(ctx)) < 0) && ...))
+  if (result < 0)
     return throwESError(ctx, DUK_ERR_TYPE_ERROR, "No matching function overload found.");
 
   return result;
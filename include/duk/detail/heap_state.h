@@ -0,0 +1,905 @@
+#ifndef DUKCPP_DETAIL_HEAP_STATE_H
+#define DUKCPP_DETAIL_HEAP_STATE_H
+
+#include <duk/common.h>
+#include <duktape.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+
+namespace duk::detail
+{
+
+
+// Per-heap dukcpp state.
+//
+// It lives in a fixed buffer referenced from the heap stash, so it's released together with the heap, and stays
+// accessible for as long as any code (including finalizers run during heap destruction) can use the heap. Duktape
+// doesn't run destructors of buffer contents, so HeapState, and all the tables it points to, need to be trivially
+// destructible. Tables live in buffers referenced from the heap stash too.
+struct HeapState;
+
+
+struct SharedPin;
+
+
+struct FunctionInfo;
+
+
+// Part of heap state which shared pins (see below) may reach on any thread, even after the heap is destroyed. It's
+// allocated outside of the heap, and reference counted by the heap and each of the pins, so it outlives all of them.
+struct HeapLink
+{
+  std::atomic<std::size_t> refCount;
+
+  // Set by the heap once it's being destroyed. Pins released from then on don't need to be unpinned.
+  std::atomic<bool> heapDestroyed;
+
+  // Lock-free multiple producer, single consumer queue of shared pins released off the owning thread. Producers push
+  // onto the head, and the owning thread takes the whole list at once (see drain_releases).
+  std::atomic<SharedPin*> releaseQueue;
+};
+
+
+// Pin shared by all copies of a thread_safe_handle. Its reference count may be changed on any thread, but pinning and
+// unpinning happen on the thread owning the heap, so the last copy released elsewhere puts it on the release queue.
+// It's allocated outside of the heap, so copies may outlive it.
+struct SharedPin
+{
+  std::atomic<std::size_t> refCount;
+  HeapLink* heapLink;
+  HeapState* heapState; // Valid until heapLink->heapDestroyed gets set.
+  void* heapPtr;
+  std::thread::id ownerThread;
+  SharedPin* nextRelease; // Release queue link.
+};
+
+
+struct HeapState
+{
+  struct PrototypeEntry
+  {
+    std::size_t typeId;
+    void* heapPtr; // nullptr marks an empty entry.
+    duk_uarridx_t refIdx; // Index in prototype reference array, which keeps prototype reachable.
+  };
+
+  struct WeakSlot
+  {
+    std::size_t generation; // Bumped when the object gets finalized, which expires weak handles pointing to it.
+    std::size_t nextFree;
+  };
+
+  struct WeakEntry
+  {
+    void* heapPtr; // nullptr marks an empty entry.
+    std::size_t slot;
+    bool chainedFinalizer; // Set if weak_finalizer replaced a finalizer of the object, and calls it in turn.
+  };
+
+  static constexpr std::size_t noWeakSlot = std::numeric_limits<std::size_t>::max();
+
+  struct FunctionSlot
+  {
+    FunctionInfo* funcInfo; // nullptr marks a free slot.
+    std::size_t nextFree;
+  };
+
+  struct PinEntry
+  {
+    void* heapPtr; // nullptr marks an empty entry.
+    std::size_t refCount;
+    duk_uarridx_t refIdx; // Index in pin reference array, which keeps pinned object reachable.
+  };
+
+  // Open addressing hash table (with linear probing) mapping type ids to prototype heap pointers. Its capacity is
+  // always a power of two.
+  PrototypeEntry* prototypes = nullptr;
+  std::size_t prototypeCapacity = 0;
+  std::size_t prototypeCount = 0;
+
+  // Same kind of table, mapping heap pointers of objects pinned by safe handles to their reference counts.
+  PinEntry* pins = nullptr;
+  std::size_t pinCapacity = 0;
+  std::size_t pinCount = 0;
+
+  // Pin reference array slots released by unpinned objects, reused before the array grows. Its capacity always
+  // matches (or exceeds) array length, so it can hold every slot.
+  duk_uarridx_t* pinFreeRefs = nullptr;
+  std::size_t pinFreeRefCount = 0;
+  std::size_t pinRefCapacity = 0;
+  std::size_t pinRefCount = 0; // Pin reference array length.
+
+  // Shared with pins of thread_safe_handle. It's created on first use.
+  HeapLink* heapLink = nullptr;
+
+  // Slots of objects referenced by weak handles, freed when their objects get finalized. Free slots form a list.
+  WeakSlot* weakSlots = nullptr;
+  std::size_t weakSlotCapacity = 0;
+  std::size_t weakSlotCount = 0;
+  std::size_t weakFreeSlot = noWeakSlot;
+
+  // Same kind of table as the pin table, mapping heap pointers of objects referenced by weak handles to their slots, so
+  // the objects themselves don't need to store them.
+  WeakEntry* weakEntries = nullptr;
+  std::size_t weakEntryCapacity = 0;
+  std::size_t weakEntryCount = 0;
+
+  // Functors of stateful callables, indexed by magic of their native functions (see function_slot). Slot 0 stands for
+  // magic 0, i.e. no slot, so it's never used, and ends the list of free slots.
+  FunctionSlot* functionSlots = nullptr;
+  std::size_t functionSlotCapacity = 0;
+  std::size_t functionSlotCount = 1;
+  std::size_t functionFreeSlot = 0;
+
+  // Prototypes of built-in typed arrays, indexed by DUK_BUFOBJ_* constants. They are looked up on first use.
+  void* typedArrayPrototypes[DUK_BUFOBJ_FLOAT64ARRAY + 1] = {};
+
+  // Prototype shared by iterator objects of C++ ranges (see make_iterable). It's created on first use.
+  void* rangeIteratorPrototype = nullptr;
+
+  // Built-in Array.prototype[Symbol.iterator], captured when the heap state is created (see is_array_iterator). It's
+  // nullptr if script code had replaced it by then.
+  void* arrayIterator = nullptr;
+
+  // Set if Duktape doesn't provide Array.prototype[Symbol.iterator] at all, so arrays without one are read by index.
+  bool arrayIndexIteration = false;
+
+  // Set once heap destruction starts (see heap_state_finalizer), so the heap state isn't cached anymore.
+  bool destroyed = false;
+};
+
+static_assert(std::is_trivially_destructible_v<HeapState>);
+static_assert(std::is_trivially_destructible_v<HeapState::PrototypeEntry>);
+static_assert(std::is_trivially_destructible_v<HeapState::PinEntry>);
+static_assert(std::is_trivially_destructible_v<HeapState::WeakSlot>);
+static_assert(std::is_trivially_destructible_v<HeapState::WeakEntry>);
+static_assert(std::is_trivially_destructible_v<HeapState::FunctionSlot>);
+static_assert(std::atomic<SharedPin*>::is_always_lock_free);
+static_assert(std::atomic<bool>::is_always_lock_free);
+
+
+inline void release_heap_link(HeapLink* heapLink) noexcept
+{
+  if (heapLink->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete heapLink;
+}
+
+
+inline void destroy_shared_pin(SharedPin* sharedPin) noexcept
+{
+  auto heapLink = sharedPin->heapLink;
+
+  delete sharedPin;
+
+  release_heap_link(heapLink);
+}
+
+
+// Frees shared pins queued after (or while) their heap got destroyed. Their objects are gone together with the heap,
+// so there is nothing to unpin. May be called on any thread.
+inline void discard_releases(HeapLink& heapLink) noexcept
+{
+  // Sequentially consistent, like the push in release_shared_pin, so either the queue is taken here, or the pusher sees
+  // the heap destroyed.
+  auto sharedPin = heapLink.releaseQueue.exchange(nullptr);
+
+  while (sharedPin)
+  {
+    auto next = sharedPin->nextRelease;
+
+    destroy_shared_pin(sharedPin);
+
+    sharedPin = next;
+  }
+}
+
+
+// Heap state used last on each thread. Heaps are told apart by their stash, which lives as long as the heap does, so
+// the lookup is skipped while the same heap is used. Stash of a destroyed heap may be reused by a new one, so heap
+// destruction bumps heap_state_epoch, which invalidates cached states on all threads.
+struct HeapStateCache
+{
+  void* stash = nullptr;
+  HeapState* heapState = nullptr;
+  std::size_t epoch = 0;
+};
+
+
+inline std::atomic<std::size_t> heap_state_epoch = 0;
+inline thread_local HeapStateCache heap_state_cache;
+
+
+// Finalizer of a sentinel object referenced from the heap stash. It stays reachable as long as the heap lives, so it's
+// only finalized when the heap is destroyed.
+inline duk_ret_t heap_state_finalizer(duk_context* ctx)
+{
+  duk_push_heap_stash(ctx);
+
+  if (duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("heapState")))
+  {
+    auto heapState = static_cast<HeapState*>(duk_get_buffer(ctx, -1, nullptr));
+    heapState->destroyed = true;
+
+    // Pins are released with the heap, so pins queued from now on are discarded by whoever queues them.
+    if (auto heapLink = std::exchange(heapState->heapLink, nullptr))
+    {
+      heapLink->heapDestroyed.store(true);
+      discard_releases(*heapLink);
+      release_heap_link(heapLink);
+    }
+  }
+
+  heap_state_epoch.fetch_add(1);
+
+  return 0;
+}
+
+
+// Returns heap state of ctx's heap, or nullptr if it hasn't been created yet. Unlike get_heap_state, it doesn't
+// allocate, so it may be called where throwing isn't allowed.
+[[nodiscard]]
+inline HeapState* find_heap_state(duk_context* ctx) noexcept
+{
+  duk_push_heap_stash(ctx);
+
+  auto stash = duk_get_heapptr(ctx, -1);
+  auto& cache = heap_state_cache;
+
+  if (cache.stash == stash && cache.epoch == heap_state_epoch.load()) [[likely]]
+  {
+    duk_pop(ctx); // Pop heap stash
+
+    return cache.heapState;
+  }
+
+  duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("heapState"));
+  auto heapState = static_cast<HeapState*>(duk_get_buffer(ctx, -1, nullptr));
+  duk_pop_2(ctx); // Pop heap state and heap stash
+
+  return heapState;
+}
+
+
+// Returns heap state of ctx's heap, creating it if necessary.
+[[nodiscard]]
+inline HeapState& get_heap_state(duk_context* ctx)
+{
+  duk_push_heap_stash(ctx);
+
+  auto stash = duk_get_heapptr(ctx, -1);
+  auto epoch = heap_state_epoch.load();
+  auto& cache = heap_state_cache;
+
+  if (cache.stash == stash && cache.epoch == epoch) [[likely]]
+  {
+    duk_pop(ctx); // Pop heap stash
+
+    return *cache.heapState;
+  }
+
+  HeapState* heapState;
+
+  if (duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("heapState"))) [[likely]]
+  {
+    heapState = static_cast<HeapState*>(duk_get_buffer(ctx, -1, nullptr));
+    duk_pop(ctx); // Pop heap state
+  }
+  else
+  {
+    duk_pop(ctx); // Pop undefined
+
+    heapState = new (duk_push_fixed_buffer(ctx, sizeof(HeapState))) HeapState{};
+    duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("heapState"));
+
+    duk_push_bare_array(ctx);
+    duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("prototypeRefs"));
+
+    duk_push_bare_array(ctx);
+    duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("pinRefs"));
+
+    duk_push_bare_array(ctx);
+    duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("weakFinalizers"));
+
+    // Arrays pushed through the API inherit the built-in Array.prototype, even if script code replaced global Array.
+    // Its built-in Symbol.iterator is the same function as values, so if they differ, script code has replaced one
+    // of them already (heap state is created before any script runs when the heap is owned by context).
+    duk_push_array(ctx);
+    duk_get_prototype(ctx, -1);
+    duk_get_prop_literal(ctx, -1, DUK_WELLKNOWN_SYMBOL("Symbol.iterator"));
+    duk_get_prop_literal(ctx, -2, "values");
+
+    auto arrayIterator = duk_get_heapptr(ctx, -2);
+    auto arrayValues = duk_get_heapptr(ctx, -1);
+
+    if (!arrayIterator && !arrayValues)
+    {
+      heapState->arrayIndexIteration = true;
+    }
+    else if (arrayIterator == arrayValues)
+    {
+      heapState->arrayIterator = arrayIterator;
+
+      duk_dup(ctx, -2);
+      duk_put_prop_literal(ctx, -6, DUKCPP_DETAIL_INTERNAL_NAME("arrayIterator"));
+    }
+
+    duk_pop_n(ctx, 4); // Pop values, iterator, prototype and array
+
+    duk_push_bare_object(ctx);
+    duk_push_c_function(ctx, heap_state_finalizer, 2);
+    duk_set_finalizer(ctx, -2);
+    duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("heapStateSentinel"));
+  }
+
+  duk_pop(ctx); // Pop heap stash
+
+  // Heap being destroyed may be freed before the epoch changes again.
+  if (!heapState->destroyed)
+    cache = { .stash = stash, .heapState = heapState, .epoch = epoch };
+
+  return *heapState;
+}
+
+
+[[nodiscard]]
+inline std::size_t table_slot(std::size_t key, std::size_t capacity) noexcept
+{
+  // Fibonacci hashing. Keys may be addresses, so their low bits can't be trusted.
+  auto shift = std::numeric_limits<std::size_t>::digits - (std::bit_width(capacity) - 1);
+
+  return (key * static_cast<std::size_t>(11400714819323198485ull)) >> shift;
+}
+
+
+[[nodiscard]]
+inline HeapState::PrototypeEntry* find_prototype_entry(
+  HeapState::PrototypeEntry* entries,
+  std::size_t capacity,
+  std::size_t typeId
+) noexcept
+{
+  if (capacity == 0)
+    return nullptr;
+
+  // Table is never full, so there always is an empty entry ending the search.
+  for (auto slot = table_slot(typeId, capacity); ; slot = (slot + 1) & (capacity - 1))
+  {
+    auto& entry = entries[slot];
+
+    if (!entry.heapPtr || entry.typeId == typeId)
+      return &entry;
+  }
+}
+
+
+// Returns heap pointer of prototype registered for typeId, or nullptr if there isn't one.
+[[nodiscard]]
+inline void* find_prototype(duk_context* ctx, std::size_t typeId)
+{
+  auto& heapState = get_heap_state(ctx);
+
+  auto entry = find_prototype_entry(heapState.prototypes, heapState.prototypeCapacity, typeId);
+
+  return entry ? entry->heapPtr : nullptr;
+}
+
+
+// Registers object at idx as the prototype for typeId, replacing previously registered one.
+inline void register_prototype(duk_context* ctx, duk_idx_t idx, std::size_t typeId)
+{
+  if (!duk_is_object(ctx, idx))
+    throw error(ctx, "prototype must be an object");
+
+  idx = duk_normalize_index(ctx, idx);
+
+  auto& heapState = get_heap_state(ctx);
+
+  duk_push_heap_stash(ctx);
+
+  // Keep load factor below 3/4.
+  if ((heapState.prototypeCount + 1) * 4 > heapState.prototypeCapacity * 3)
+  {
+    auto newCapacity = heapState.prototypeCapacity ? heapState.prototypeCapacity * 2 : 8;
+
+    // Zero-initialized, so all entries start empty.
+    auto newEntries = static_cast<HeapState::PrototypeEntry*>(
+      duk_push_fixed_buffer(ctx, newCapacity * sizeof(HeapState::PrototypeEntry))
+    );
+
+    // Allocation may have run finalizers, which could have grown the table already.
+    if (newCapacity > heapState.prototypeCapacity)
+    {
+      for (std::size_t i = 0; i < heapState.prototypeCapacity; ++i)
+      {
+        const auto& entry = heapState.prototypes[i];
+
+        if (entry.heapPtr)
+          *find_prototype_entry(newEntries, newCapacity, entry.typeId) = entry;
+      }
+
+      duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("prototypes"));
+
+      heapState.prototypes = newEntries;
+      heapState.prototypeCapacity = newCapacity;
+    }
+    else
+    {
+      duk_pop(ctx); // Pop unused buffer
+    }
+  }
+
+  auto entry = find_prototype_entry(heapState.prototypes, heapState.prototypeCapacity, typeId);
+
+  if (!entry->heapPtr)
+  {
+    entry->typeId = typeId;
+    entry->refIdx = static_cast<duk_uarridx_t>(heapState.prototypeCount++);
+  }
+
+  entry->heapPtr = duk_get_heapptr(ctx, idx);
+
+  duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("prototypeRefs"));
+  duk_dup(ctx, idx);
+  duk_put_prop_index(ctx, -2, entry->refIdx);
+
+  duk_pop_2(ctx); // Pop prototype reference array and heap stash
+}
+
+
+[[nodiscard]]
+inline std::size_t heap_ptr_key(void* heapPtr) noexcept
+{
+  return reinterpret_cast<std::uintptr_t>(heapPtr);
+}
+
+
+// Finds entry of heapPtr in a table keyed by heap pointers (pins and weak entries), or the empty entry it would take.
+template<typename Entry>
+[[nodiscard]]
+Entry* find_heap_ptr_entry(Entry* entries, std::size_t capacity, void* heapPtr) noexcept
+{
+  if (capacity == 0)
+    return nullptr;
+
+  // Table is never full, so there always is an empty entry ending the search.
+  for (auto slot = table_slot(heap_ptr_key(heapPtr), capacity); ; slot = (slot + 1) & (capacity - 1))
+  {
+    auto& entry = entries[slot];
+
+    if (!entry.heapPtr || entry.heapPtr == heapPtr)
+      return &entry;
+  }
+}
+
+
+// Backward shift deletion, so lookups don't need tombstones. Entries following the removed one are moved back, unless
+// that would move them before their home slot.
+template<typename Entry>
+void erase_heap_ptr_entry(Entry* entries, std::size_t capacity, Entry* entry) noexcept
+{
+  auto mask = capacity - 1;
+  auto hole = static_cast<std::size_t>(entry - entries);
+
+  for (auto slot = (hole + 1) & mask; entries[slot].heapPtr; slot = (slot + 1) & mask)
+  {
+    auto home = table_slot(heap_ptr_key(entries[slot].heapPtr), capacity);
+
+    if (((slot - home) & mask) >= ((slot - hole) & mask))
+    {
+      entries[hole] = entries[slot];
+      hole = slot;
+    }
+  }
+
+  entries[hole].heapPtr = nullptr;
+}
+
+
+inline void put_pin_ref(duk_context* ctx, duk_uarridx_t refIdx, void* heapPtr)
+{
+  duk_push_heap_stash(ctx);
+  duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("pinRefs"));
+
+  if (heapPtr)
+    duk_push_heapptr(ctx, heapPtr);
+  else
+    duk_push_undefined(ctx);
+
+  duk_put_prop_index(ctx, -2, refIdx);
+
+  duk_pop_2(ctx); // Pop pin reference array and heap stash
+}
+
+
+[[nodiscard]]
+inline duk_uarridx_t acquire_pin_ref(duk_context* ctx, HeapState& heapState)
+{
+  if (heapState.pinFreeRefCount != 0)
+    return heapState.pinFreeRefs[--heapState.pinFreeRefCount];
+
+  if (heapState.pinRefCount == heapState.pinRefCapacity)
+  {
+    auto newCapacity = heapState.pinRefCapacity ? heapState.pinRefCapacity * 2 : 8;
+
+    duk_push_heap_stash(ctx);
+
+    auto newFreeRefs = static_cast<duk_uarridx_t*>(duk_push_fixed_buffer(ctx, newCapacity * sizeof(duk_uarridx_t)));
+
+    // Allocation may have run finalizers, which could have grown the buffer already.
+    if (newCapacity > heapState.pinRefCapacity)
+    {
+      std::copy_n(heapState.pinFreeRefs, heapState.pinFreeRefCount, newFreeRefs);
+
+      duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("pinFreeRefs"));
+
+      heapState.pinFreeRefs = newFreeRefs;
+      heapState.pinRefCapacity = newCapacity;
+    }
+    else
+    {
+      duk_pop(ctx); // Pop unused buffer
+    }
+
+    duk_pop(ctx); // Pop heap stash
+  }
+
+  return static_cast<duk_uarridx_t>(heapState.pinRefCount++);
+}
+
+
+// Increments reference count of a heap object, keeping it reachable (and its heap pointer stable) until it drops to
+// zero. Once the table is found, this is a single hash probe, unless the object gets pinned for the first time.
+inline void pin(duk_context* ctx, HeapState& heapState, void* heapPtr)
+{
+  auto entry = find_heap_ptr_entry(heapState.pins, heapState.pinCapacity, heapPtr);
+
+  if (entry && entry->heapPtr) [[likely]]
+  {
+    ++entry->refCount;
+
+    return;
+  }
+
+  // Keep load factor below 3/4.
+  if ((heapState.pinCount + 1) * 4 > heapState.pinCapacity * 3)
+  {
+    auto newCapacity = heapState.pinCapacity ? heapState.pinCapacity * 2 : 16;
+
+    duk_push_heap_stash(ctx);
+
+    // Zero-initialized, so all entries start empty.
+    auto newEntries = static_cast<HeapState::PinEntry*>(
+      duk_push_fixed_buffer(ctx, newCapacity * sizeof(HeapState::PinEntry))
+    );
+
+    // Allocation may have run finalizers, which could have grown the table already.
+    if (newCapacity > heapState.pinCapacity)
+    {
+      for (std::size_t i = 0; i < heapState.pinCapacity; ++i)
+      {
+        const auto& oldEntry = heapState.pins[i];
+
+        if (oldEntry.heapPtr)
+          *find_heap_ptr_entry(newEntries, newCapacity, oldEntry.heapPtr) = oldEntry;
+      }
+
+      duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("pins"));
+
+      heapState.pins = newEntries;
+      heapState.pinCapacity = newCapacity;
+    }
+    else
+    {
+      duk_pop(ctx); // Pop unused buffer
+    }
+
+    duk_pop(ctx); // Pop heap stash
+  }
+
+  auto refIdx = acquire_pin_ref(ctx, heapState);
+  put_pin_ref(ctx, refIdx, heapPtr);
+
+  // Calls above may trigger garbage collection, and finalizers run by it may pin or unpin objects too, so the entry
+  // needs to be looked up again.
+  entry = find_heap_ptr_entry(heapState.pins, heapState.pinCapacity, heapPtr);
+
+  if (entry->heapPtr) [[unlikely]]
+  {
+    ++entry->refCount;
+
+    put_pin_ref(ctx, refIdx, nullptr);
+    heapState.pinFreeRefs[heapState.pinFreeRefCount++] = refIdx;
+
+    return;
+  }
+
+  *entry = { .heapPtr = heapPtr, .refCount = 1, .refIdx = refIdx };
+  ++heapState.pinCount;
+}
+
+
+// Decrements reference count of a pinned heap object. Once it drops to zero, the object is released.
+inline void unpin(duk_context* ctx, HeapState& heapState, void* heapPtr)
+{
+  auto entry = find_heap_ptr_entry(heapState.pins, heapState.pinCapacity, heapPtr);
+  if (!entry || !entry->heapPtr) [[unlikely]]
+    duk_fatal(ctx, "handle corrupted (unpin)");
+
+  if (--entry->refCount != 0) [[likely]]
+    return;
+
+  auto refIdx = entry->refIdx;
+
+  erase_heap_ptr_entry(heapState.pins, heapState.pinCapacity, entry);
+  --heapState.pinCount;
+
+  put_pin_ref(ctx, refIdx, nullptr);
+  heapState.pinFreeRefs[heapState.pinFreeRefCount++] = refIdx;
+}
+
+
+[[nodiscard]]
+inline SharedPin* make_shared_pin(duk_context* ctx, void* heapPtr)
+{
+  auto& heapState = get_heap_state(ctx);
+
+  // Objects of a heap being destroyed are released anyway, so there is nothing to pin, and the pin gets a link of its
+  // own, which already tells so.
+  if (heapState.destroyed) [[unlikely]]
+  {
+    auto heapLink = new HeapLink{ 1, true, nullptr };
+
+    return new SharedPin{ 1, heapLink, &heapState, heapPtr, std::this_thread::get_id(), nullptr };
+  }
+
+  // Heap holds a reference to its link, released when the heap is destroyed (see heap_state_finalizer).
+  if (!heapState.heapLink)
+    heapState.heapLink = new HeapLink{ 1, false, nullptr };
+
+  pin(ctx, heapState, heapPtr);
+
+  heapState.heapLink->refCount.fetch_add(1, std::memory_order_relaxed);
+
+  return new SharedPin{ 1, heapState.heapLink, &heapState, heapPtr, std::this_thread::get_id(), nullptr };
+}
+
+
+// Drops a reference to the shared pin. May be called on any thread, also after the heap has been destroyed.
+inline void release_shared_pin(duk_context* ctx, SharedPin* sharedPin) noexcept
+{
+  if (sharedPin->refCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    return;
+
+  auto& heapLink = *sharedPin->heapLink;
+
+  if (heapLink.heapDestroyed.load())
+  {
+    destroy_shared_pin(sharedPin);
+
+    return;
+  }
+
+  if (std::this_thread::get_id() == sharedPin->ownerThread)
+  {
+    unpin(ctx, *sharedPin->heapState, sharedPin->heapPtr);
+    destroy_shared_pin(sharedPin);
+
+    return;
+  }
+
+  // Queued pin may be discarded (and release the last reference to heap link) right after it's pushed, so the link is
+  // kept alive until the heap state is checked again.
+  heapLink.refCount.fetch_add(1, std::memory_order_relaxed);
+
+  sharedPin->nextRelease = heapLink.releaseQueue.load(std::memory_order_relaxed);
+  while (!heapLink.releaseQueue.compare_exchange_weak(sharedPin->nextRelease, sharedPin));
+
+  // Heap may have been destroyed in the meantime, in which case nobody else will take the queue.
+  if (heapLink.heapDestroyed.load())
+    discard_releases(heapLink);
+
+  release_heap_link(&heapLink);
+}
+
+
+// Releases shared pins queued by other threads. Needs to be called on the thread owning the heap.
+inline void drain_releases(duk_context* ctx, HeapState& heapState) noexcept
+{
+  if (!heapState.heapLink)
+    return;
+
+  auto sharedPin = heapState.heapLink->releaseQueue.exchange(nullptr, std::memory_order_acquire);
+
+  while (sharedPin)
+  {
+    auto next = sharedPin->nextRelease;
+
+    unpin(ctx, heapState, sharedPin->heapPtr);
+    destroy_shared_pin(sharedPin);
+
+    sharedPin = next;
+  }
+}
+
+
+// Returns weak slot of object pointed by heapPtr, or HeapState::noWeakSlot if it doesn't have one.
+[[nodiscard]]
+inline std::size_t find_weak_slot(const HeapState& heapState, void* heapPtr) noexcept
+{
+  auto entry = find_heap_ptr_entry(heapState.weakEntries, heapState.weakEntryCapacity, heapPtr);
+
+  return entry && entry->heapPtr ? entry->slot : HeapState::noWeakSlot;
+}
+
+
+// Allocates weak slot for object pointed by heapPtr, which doesn't have one yet.
+[[nodiscard]]
+inline std::size_t acquire_weak_slot(duk_context* ctx, HeapState& heapState, void* heapPtr)
+{
+  duk_push_heap_stash(ctx);
+
+  if (heapState.weakFreeSlot == HeapState::noWeakSlot && heapState.weakSlotCount == heapState.weakSlotCapacity)
+  {
+    auto newCapacity = heapState.weakSlotCapacity ? heapState.weakSlotCapacity * 2 : 16;
+
+    auto newSlots = static_cast<HeapState::WeakSlot*>(
+      duk_push_fixed_buffer(ctx, newCapacity * sizeof(HeapState::WeakSlot))
+    );
+
+    // Allocation may have run finalizers, which could have grown the buffer already.
+    if (newCapacity > heapState.weakSlotCapacity)
+    {
+      std::copy_n(heapState.weakSlots, heapState.weakSlotCount, newSlots);
+
+      duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("weakSlots"));
+
+      heapState.weakSlots = newSlots;
+      heapState.weakSlotCapacity = newCapacity;
+    }
+    else
+    {
+      duk_pop(ctx); // Pop unused buffer
+    }
+  }
+
+  // Keep load factor below 3/4.
+  if ((heapState.weakEntryCount + 1) * 4 > heapState.weakEntryCapacity * 3)
+  {
+    auto newCapacity = heapState.weakEntryCapacity ? heapState.weakEntryCapacity * 2 : 16;
+
+    // Zero-initialized, so all entries start empty.
+    auto newEntries = static_cast<HeapState::WeakEntry*>(
+      duk_push_fixed_buffer(ctx, newCapacity * sizeof(HeapState::WeakEntry))
+    );
+
+    // Allocation may have run finalizers, which could have grown the table already.
+    if (newCapacity > heapState.weakEntryCapacity)
+    {
+      for (std::size_t i = 0; i < heapState.weakEntryCapacity; ++i)
+      {
+        const auto& oldEntry = heapState.weakEntries[i];
+
+        if (oldEntry.heapPtr)
+          *find_heap_ptr_entry(newEntries, newCapacity, oldEntry.heapPtr) = oldEntry;
+      }
+
+      duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("weakEntries"));
+
+      heapState.weakEntries = newEntries;
+      heapState.weakEntryCapacity = newCapacity;
+    }
+    else
+    {
+      duk_pop(ctx); // Pop unused buffer
+    }
+  }
+
+  duk_pop(ctx); // Pop heap stash
+
+  std::size_t slot;
+
+  if (heapState.weakFreeSlot != HeapState::noWeakSlot)
+  {
+    slot = heapState.weakFreeSlot;
+    heapState.weakFreeSlot = heapState.weakSlots[slot].nextFree;
+  }
+  else
+  {
+    slot = heapState.weakSlotCount++;
+    heapState.weakSlots[slot].generation = 0;
+  }
+
+  *find_heap_ptr_entry(heapState.weakEntries, heapState.weakEntryCapacity, heapPtr) = {
+    .heapPtr = heapPtr,
+    .slot = slot,
+    .chainedFinalizer = false
+  };
+
+  ++heapState.weakEntryCount;
+
+  return slot;
+}
+
+
+// Expires weak handles using the slot of given entry, and frees both.
+inline void release_weak_slot(HeapState& heapState, HeapState::WeakEntry* entry) noexcept
+{
+  auto slot = entry->slot;
+
+  erase_heap_ptr_entry(heapState.weakEntries, heapState.weakEntryCapacity, entry);
+  --heapState.weakEntryCount;
+
+  auto& weakSlot = heapState.weakSlots[slot];
+  ++weakSlot.generation;
+  weakSlot.nextFree = heapState.weakFreeSlot;
+  heapState.weakFreeSlot = slot;
+}
+
+
+// Called from finalizers. Expires weak handles pointing to object at idx, if there are any. If weak_finalizer replaced
+// a finalizer of the object, pushes that finalizer and returns true.
+inline bool expire_weak_slot(duk_context* ctx, duk_idx_t idx)
+{
+  auto heapState = find_heap_state(ctx);
+  if (!heapState)
+    return false;
+
+  auto entry = find_heap_ptr_entry(heapState->weakEntries, heapState->weakEntryCapacity, duk_get_heapptr(ctx, idx));
+  if (!entry || !entry->heapPtr)
+    return false;
+
+  auto slot = entry->slot;
+  auto chainedFinalizer = entry->chainedFinalizer;
+
+  release_weak_slot(*heapState, entry);
+
+  if (!chainedFinalizer)
+    return false;
+
+  duk_push_heap_stash(ctx);
+  duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("weakFinalizers"));
+  duk_get_prop_index(ctx, -1, static_cast<duk_uarridx_t>(slot));
+
+  duk_push_undefined(ctx);
+  duk_put_prop_index(ctx, -3, static_cast<duk_uarridx_t>(slot));
+
+  duk_remove(ctx, -2); // Remove weak finalizer array
+  duk_remove(ctx, -2); // Remove heap stash
+
+  return true;
+}
+
+
+// Pushes finalizer shared by all objects of a kind living in the heap. It's created on first use and cached in the heap
+// stash, so pushing a value doesn't allocate a new function object.
+inline void push_shared_finalizer(duk_context* ctx, std::string_view name, duk_c_function finalizer)
+{
+  duk_push_heap_stash(ctx);
+
+  if (!get_prop_string(ctx, -1, name))
+  {
+    duk_pop(ctx);
+
+    duk_push_c_function(ctx, finalizer, 2);
+    duk_dup_top(ctx);
+    put_prop_string(ctx, -3, name);
+  }
+
+  duk_remove(ctx, -2); // Remove heap stash
+}
+
+
+} // namespace duk::detail
+
+
+#endif // DUKCPP_DETAIL_HEAP_STATE_H
@@ -0,0 +1,95 @@
+#ifndef DUKCPP_DETAIL_RANGE_CURSOR_H
+#define DUKCPP_DETAIL_RANGE_CURSOR_H
+
+#include <duk/common.h>
+#include <duk/type_traits_helpers.h>
+#include <duktape.h>
+#include <memory>
+#include <ranges>
+#include <string_view>
+
+
+namespace duk::detail
+{
+
+
+// Marks Symbol.iterator functions installed by make_iterable, so C++ code iterating their objects can skip the ES
+// iterator protocol, and walk the underlying C++ range directly.
+static constexpr auto range_iterator_marker_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("rangeIter"));
+
+
+// Type-erased position in a C++ range owned by an ES object (see ObjectInfo::makeRangeCursor).
+struct RangeCursor
+{
+  virtual ~RangeCursor() = default;
+
+  [[nodiscard]]
+  virtual bool done() const noexcept = 0;
+
+  // Pushes current element.
+  virtual void push(duk_context* ctx) const = 0;
+
+  virtual void next() = 0;
+
+  virtual void destroy() noexcept = 0;
+
+  // Heap pointer of the ES iterator object owning the cursor (see range_iterator_factory), if any.
+  void* owner = nullptr;
+
+  // Set once the ES iterator has returned current element, so the range is advanced by the following call to next,
+  // not any earlier.
+  bool advancePending = false;
+};
+
+
+struct RangeCursorDeleter
+{
+  void operator()(RangeCursor* cursor) const noexcept
+  {
+    cursor->destroy();
+  }
+};
+
+
+using range_cursor_ptr = std::unique_ptr<RangeCursor, RangeCursorDeleter>;
+
+
+template<typename Range>
+struct RangeCursorImpl : RangeCursor
+{
+  RangeCursorImpl(duk_context* ctx, Range& range) :
+    ctx_(ctx),
+    range_(range)
+  {
+  }
+
+  [[nodiscard]]
+  bool done() const noexcept override
+  {
+    return range_.begin() == range_.end();
+  }
+
+  void push(duk_context* ctx) const override
+  {
+    duk::push(ctx, *range_.begin());
+  }
+
+  void next() override
+  {
+    range_.advance(1);
+  }
+
+  void destroy() noexcept override
+  {
+    free(ctx_, this);
+  }
+
+  duk_context* ctx_ = nullptr;
+  std::ranges::subrange<std::ranges::iterator_t<Range>, std::ranges::sentinel_t<Range>> range_;
+};
+
+
+} // namespace duk::detail
+
+
+#endif // DUKCPP_DETAIL_RANGE_CURSOR_H
@@ -0,0 +1,154 @@
+#ifndef DUKCPP_DETAIL_RANGE_ITERATOR_H
+#define DUKCPP_DETAIL_RANGE_ITERATOR_H
+
+#include <duk/common.h>
+#include <duk/detail/heap_state.h>
+#include <duk/detail/range_cursor.h>
+#include <duk/scoped_pop.h>
+#include <duk/type_traits_helpers.h>
+#include <duktape.h>
+#include <string_view>
+
+
+namespace duk::detail
+{
+
+
+// Iterator objects of C++ ranges keep their cursor, the iterated object (so the range outlives the iterator), and
+// a result object reused by every call to next.
+static constexpr auto range_iterator_cursor_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("iterCursor"));
+static constexpr auto range_iterator_target_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("iterTarget"));
+static constexpr auto range_iterator_result_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("iterResult"));
+
+
+// Returns nullptr if value at idx isn't an iterator object of a C++ range (or it's been finalized).
+[[nodiscard]]
+inline RangeCursor* get_range_iterator_cursor(duk_context* ctx, duk_idx_t idx) noexcept
+{
+  scoped_pop _(ctx); // get_prop_string
+  if (!get_prop_string(ctx, idx, range_iterator_cursor_name))
+    return nullptr;
+
+  return static_cast<RangeCursor*>(duk_get_pointer(ctx, -1));
+}
+
+
+inline duk_ret_t range_iterator_next(duk_context* ctx)
+{
+  duk_push_this(ctx);
+
+  auto cursor = get_range_iterator_cursor(ctx, -1);
+  if (!cursor) [[unlikely]]
+    return duk_error(ctx, DUK_ERR_TYPE_ERROR, "not a native iterator");
+
+  if (cursor->advancePending)
+  {
+    cursor->advancePending = false;
+    cursor->next();
+  }
+
+  get_prop_string(ctx, -1, range_iterator_result_name);
+
+  auto done = cursor->done();
+
+  if (done)
+    duk_push_undefined(ctx);
+  else
+    cursor->push(ctx);
+
+  duk_put_prop_literal(ctx, -2, "value");
+
+  duk_push_boolean(ctx, done);
+  duk_put_prop_literal(ctx, -2, "done");
+
+  cursor->advancePending = !done;
+
+  return 1;
+}
+
+
+static constexpr auto range_iterator_finalizer_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("iterFinalizer"));
+
+
+inline duk_ret_t range_iterator_finalizer(duk_context* ctx)
+{
+  expire_weak_slot(ctx, 0);
+
+  // Objects inheriting from an iterator inherit its finalizer and cursor too. Only the iterator may release it.
+  auto cursor = get_range_iterator_cursor(ctx, 0);
+  if (!cursor || cursor->owner != duk_get_heapptr(ctx, 0))
+    return 0;
+
+  duk_push_pointer(ctx, nullptr);
+  put_prop_string(ctx, 0, range_iterator_cursor_name);
+
+  cursor->destroy();
+
+  return 0;
+}
+
+
+// Returns heap pointer of the prototype shared by iterator objects of C++ ranges. It holds the only next function, and
+// the finalizer releasing cursors.
+[[nodiscard]]
+inline void* get_range_iterator_prototype(duk_context* ctx)
+{
+  auto& heapState = get_heap_state(ctx);
+
+  if (heapState.rangeIteratorPrototype) [[likely]]
+    return heapState.rangeIteratorPrototype;
+
+  duk_push_object(ctx);
+
+  duk_push_c_function(ctx, range_iterator_next, 0);
+  duk_put_prop_literal(ctx, -2, "next");
+
+  push_shared_finalizer(ctx, range_iterator_finalizer_name, range_iterator_finalizer);
+  duk_set_finalizer(ctx, -2);
+
+  duk_push_heap_stash(ctx);
+  duk_dup(ctx, -2);
+  duk_put_prop_literal(ctx, -2, DUKCPP_DETAIL_INTERNAL_NAME("rangeIteratorPrototype"));
+
+  heapState.rangeIteratorPrototype = duk_get_heapptr(ctx, -2);
+
+  duk_pop_2(ctx); // Pop heap stash and prototype
+
+  return heapState.rangeIteratorPrototype;
+}
+
+
+// Symbol.iterator function of objects wrapping C++ ranges of type T. It's stateless, so it doesn't need a closure,
+// and creates a single iterator object, whose C++ iterators are kept by a cursor.
+template<typename T>
+duk_ret_t range_iterator_factory(duk_context* ctx)
+{
+  duk_push_this(ctx);
+
+  auto& range = duk::get<T&>(ctx, -1);
+
+  duk_push_object(ctx);
+
+  duk_push_heapptr(ctx, get_range_iterator_prototype(ctx));
+  duk_set_prototype(ctx, -2);
+
+  duk_dup(ctx, -2);
+  put_prop_string(ctx, -2, range_iterator_target_name);
+
+  duk_push_object(ctx);
+  put_prop_string(ctx, -2, range_iterator_result_name);
+
+  RangeCursor* cursor = make<RangeCursorImpl<T>>(ctx, ctx, range);
+  cursor->owner = duk_get_heapptr(ctx, -1);
+
+  duk_push_pointer(ctx, cursor);
+  put_prop_string(ctx, -2, range_iterator_cursor_name);
+
+  return 1;
+}
+
+
+} // namespace duk::detail
+
+
+#endif // DUKCPP_DETAIL_RANGE_ITERATOR_H
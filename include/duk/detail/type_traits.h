@@ -1,8 +1,14 @@
 #ifndef DUKCPP_DETAIL_TYPE_TRAITS_H
 #define DUKCPP_DETAIL_TYPE_TRAITS_H
 
+#include <duk/array_snapshot.h>
 #include <duk/class.h>
 #include <duk/common.h>
+#include <duk/detail/function_slots.h>
+#include <duk/detail/function_wrapper.h>
+#include <duk/detail/heap_state.h>
+#include <duk/detail/range_cursor.h>
+#include <duk/detail/typed_array.h>
 #include <duk/error.h>
 #include <duk/function_handle.h>
 #include <duk/iterable.h>
@@ -10,8 +16,15 @@
 #include <duk/scoped_pop.h>
 #include <duk/string_traits.h>
 #include <duk/type_adapter.h>
+#include <duk/typed_array.h>
 #include <boost/callable_traits.hpp>
 #include <duktape.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ranges>
+#include <span>
 #include <type_traits>
 
 
@@ -19,19 +32,24 @@ namespace duk::detail
 {
 
 
-template<typename Signature, typename ArgIdx, bool IsPropertyCall>
-struct FunctionWrapper;
-
-
 struct ObjectInfo
 {
-  ObjectInfo(duk_context* ctx) :
-    ctx_(ctx)
+  ObjectInfo(duk_context* ctx, void* heapPtr) :
+    ctx_(ctx),
+    heapPtr_(heapPtr)
   {
   }
 
   virtual ~ObjectInfo() = default;
 
+  // Objects inheriting from the wrapper (e.g. created with Object.create) see its ObjectInfo through the prototype
+  // chain, and inherit its finalizer too. Only the wrapper itself may finalize it.
+  [[nodiscard]]
+  bool isOwnedBy(void* heapPtr) const noexcept
+  {
+    return heapPtr_ == heapPtr;
+  }
+
   [[nodiscard]]
   virtual bool checkType(std::size_t typeId) noexcept = 0;
 
@@ -39,6 +57,14 @@ struct ObjectInfo
 
   virtual void clone() = 0;
 
+  // Copy mirrored data members (see class_traits_mirror) from ES object at idx to C++ object, and the other way round.
+  virtual void syncMirror(duk_idx_t idx) = 0;
+  virtual void refreshMirror(duk_idx_t idx) = 0;
+
+  // Returns cursor at the beginning of the C++ range, or nullptr if the object isn't iterable.
+  [[nodiscard]]
+  virtual RangeCursor* makeRangeCursor() = 0;
+
   // What's happening here is quite hard to follow, so here is a short explanation.
   //
   // Depending on whether requested T has a type adapter, we return either T (adapter exists) or T& (adapter
@@ -85,16 +111,21 @@ protected:
   duk_context* ctx_ = nullptr;
 
 private:
+  void* heapPtr_ = nullptr;
+
   [[nodiscard]]
   virtual bool getImpl(std::size_t typeId, std::byte* buffer) = 0;
 };
 
 
-template<typename T>
+// InlineStorage means that ObjectInfoImpl lives in a Duktape buffer owned by the wrapper object (see
+// class_traits_inline_storage), so finalization only needs to destroy it. Memory is reclaimed by Duktape's GC.
+// Iterable means that the object has been made iterable in ES (see make_iterable).
+template<typename T, bool InlineStorage = false, bool Iterable = false>
 struct ObjectInfoImpl : ObjectInfo
 {
-  ObjectInfoImpl(duk_context* ctx, auto&& obj) :
-    ObjectInfo(ctx),
+  ObjectInfoImpl(duk_context* ctx, void* heapPtr, auto&& obj) :
+    ObjectInfo(ctx, heapPtr),
     obj_(std::forward<decltype(obj)>(obj))
   {
   }
@@ -107,7 +138,10 @@ struct ObjectInfoImpl : ObjectInfo
 
   void finalize() noexcept override
   {
-    free(ctx_, this);
+    if constexpr (InlineStorage)
+      std::destroy_at(this);
+    else
+      free(ctx_, this);
   }
 
   void clone() override
@@ -118,7 +152,39 @@ struct ObjectInfoImpl : ObjectInfo
       throw error(ctx_, "type not cloneable");
   }
 
+  void syncMirror([[maybe_unused]] duk_idx_t idx) override
+  {
+    if constexpr (has_class_traits_mirror<AdaptedT>)
+      class_traits_mirror_t<AdaptedT>::sync(ctx_, idx, adapted());
+  }
+
+  void refreshMirror([[maybe_unused]] duk_idx_t idx) override
+  {
+    if constexpr (has_class_traits_mirror<AdaptedT>)
+      class_traits_mirror_t<AdaptedT>::push(ctx_, idx, adapted());
+  }
+
+  [[nodiscard]]
+  RangeCursor* makeRangeCursor() override
+  {
+    if constexpr (Iterable)
+      return make<RangeCursorImpl<AdaptedT>>(ctx_, ctx_, adapted());
+    else
+      return nullptr;
+  }
+
 private:
+  using AdaptedT = type_adapter_type_t<T>;
+
+  [[nodiscard]]
+  AdaptedT& adapted()
+  {
+    if constexpr (has_type_adapter<T>)
+      return type_adapter<T>::template get<AdaptedT&>(obj_);
+    else
+      return obj_;
+  }
+
   template<has_type_adapter Type>
   [[nodiscard]]
   bool getImplType(std::size_t typeId, std::byte* buffer)
@@ -195,6 +261,105 @@ private:
 static constexpr auto type_traits_object_info_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("objInfo"));
 
 
+// Returns nullptr if value at idx isn't an object created by dukcpp (or it's been finalized).
+inline ObjectInfo* get_object_info(duk_context* ctx, duk_idx_t idx) noexcept
+{
+  if (!duk_is_object(ctx, idx))
+    return nullptr;
+
+  scoped_pop _(ctx); // get_prop_string
+  if (!get_prop_string(ctx, idx, type_traits_object_info_name))
+    return nullptr;
+
+  // Objects using inline storage keep their ObjectInfo at the beginning of a fixed buffer, others keep a pointer.
+  if (duk_is_buffer(ctx, -1))
+    return static_cast<ObjectInfo*>(duk_get_buffer(ctx, -1, nullptr));
+
+  return static_cast<ObjectInfo*>(duk_get_pointer(ctx, -1));
+}
+
+
+// Same as get_object_info, but ignores ObjectInfo inherited from the prototype chain.
+inline ObjectInfo* get_own_object_info(duk_context* ctx, duk_idx_t idx) noexcept
+{
+  auto heapPtr = duk_get_heapptr(ctx, idx);
+
+  auto objInfo = get_object_info(ctx, idx);
+  if (!objInfo || !objInfo->isOwnedBy(heapPtr))
+    return nullptr;
+
+  return objInfo;
+}
+
+
+// Returns nullptr unless object at objIdx is iterated by Symbol.iterator function (at iterFuncIdx) installed by
+// make_iterable.
+inline RangeCursor* make_range_cursor(duk_context* ctx, duk_idx_t objIdx, duk_idx_t iterFuncIdx)
+{
+  if (!duk_is_function(ctx, iterFuncIdx))
+    return nullptr;
+
+  {
+    scoped_pop _(ctx); // get_prop_string
+    if (!get_prop_string(ctx, iterFuncIdx, range_iterator_marker_name))
+      return nullptr;
+  }
+
+  auto objInfo = get_object_info(ctx, objIdx);
+  if (!objInfo)
+    return nullptr;
+
+  return objInfo->makeRangeCursor();
+}
+
+
+// Finalizers are shared by all objects (and callables) living in a heap. They are created on first use and cached in
+// the heap stash, so pushing a value doesn't allocate a new function object.
+static constexpr auto object_finalizer_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("objFinalizer"));
+
+
+inline duk_ret_t object_finalizer(duk_context* ctx)
+{
+  expire_weak_slot(ctx, 0);
+
+  auto objInfo = get_own_object_info(ctx, 0);
+  if (!objInfo)
+    return 0;
+
+  objInfo->finalize();
+
+  return 0;
+}
+
+
+// Installed on objects referenced by weak handles, which don't have a finalizer managed by dukcpp. Finalizer it replaced
+// (if any) is called once weak handles have expired.
+static constexpr auto weak_finalizer_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("weakFinalizer"));
+
+
+inline duk_ret_t weak_finalizer(duk_context* ctx)
+{
+  if (expire_weak_slot(ctx, 0))
+  {
+    duk_dup(ctx, 0);
+    duk_dup(ctx, 1);
+    duk_call(ctx, 2);
+  }
+
+  return 0;
+}
+
+
+// Makes sure object at the top of the stack gets finalized. Finalizer is installed on the object itself, even if it has
+// a prototype, since an inherited one would be lost if script code replaced the prototype. Finalizer function is shared,
+// so this only costs a property.
+inline void set_object_finalizer(duk_context* ctx)
+{
+  push_shared_finalizer(ctx, object_finalizer_name, object_finalizer);
+  duk_set_finalizer(ctx, -2);
+}
+
+
 template<typename T, type_traits_options options>
 struct type_traits
 {
@@ -202,47 +367,60 @@ struct type_traits
 
   static constexpr bool is_object = true;
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT;
+
   static void push(duk_context* ctx, auto&& obj, void* prototype_heap_ptr = nullptr)
   {
-    using ObjectInfoImplT = ObjectInfoImpl<DecayT>;
-
-    static_assert(std::is_convertible_v<std::decay_t<decltype(obj)>, DecayT>);
-
-    static constexpr auto finalizer = [](duk_context* ctx) -> duk_ret_t
-    {
-      scoped_pop _(ctx); // get_prop_string
-      if (!get_prop_string(ctx, 0, type_traits_object_info_name))
-        return 0;
+    using AdaptedT = type_adapter_type_t<DecayT>;
 
-      auto objInfo = static_cast<ObjectInfoImplT*>(duk_get_pointer(ctx, -1));
+    static constexpr bool inlineStorage = has_class_traits_inline_storage<AdaptedT>;
 
-      free(ctx, objInfo);
+    static constexpr bool isIterable = iterable<AdaptedT> || options.iterable;
 
-      return 0;
-    };
+    using ObjectInfoImplT = ObjectInfoImpl<DecayT, false, isIterable>;
+    using InlineObjectInfoImplT = ObjectInfoImpl<DecayT, true, isIterable>;
 
-    auto* objInfo = make<ObjectInfoImplT>(ctx, ctx, std::forward<decltype(obj)>(obj));
+    static_assert(std::is_convertible_v<std::decay_t<decltype(obj)>, DecayT>);
 
     if (duk_is_constructor_call(ctx))
       duk_push_this(ctx);
     else
       duk_push_object(ctx);
 
+    auto heapPtr = duk_get_heapptr(ctx, -1);
+
     duk::push(ctx, type_traits_object_info_name);
-    duk_push_pointer(ctx, objInfo);
+
+    ObjectInfo* objInfo = nullptr;
+
+    if constexpr (inlineStorage)
+    {
+      // Buffer data is only aligned to 8 bytes by Duktape builds with DUK_USE_ALIGN_BY == 8, so objects which don't
+      // fit in suitably aligned buffer are allocated separately instead.
+      auto buffer = duk_push_buffer_raw(ctx, sizeof(InlineObjectInfoImplT), DUK_BUF_FLAG_NOZERO);
+
+      if (reinterpret_cast<std::uintptr_t>(buffer) % alignof(InlineObjectInfoImplT) == 0) [[likely]]
+        objInfo = new (buffer) InlineObjectInfoImplT(ctx, heapPtr, std::forward<decltype(obj)>(obj));
+      else
+        duk_pop(ctx); // Pop misaligned buffer
+    }
+
+    if (!objInfo)
+    {
+      objInfo = make<ObjectInfoImplT>(ctx, ctx, heapPtr, std::forward<decltype(obj)>(obj));
+      duk_push_pointer(ctx, objInfo);
+    }
+
     duk_def_prop(ctx, -3,
       DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_CLEAR_WRITABLE | DUK_DEFPROP_CLEAR_ENUMERABLE | DUK_DEFPROP_SET_CONFIGURABLE
     );
 
-    duk_push_c_function(ctx, finalizer, 2);
-    duk_set_finalizer(ctx, -2);
-
-    using AdaptedT = type_adapter_type_t<DecayT>;
-
-    if constexpr (has_class_traits_prototype<AdaptedT>)
+    if (!prototype_heap_ptr)
     {
-      if (!prototype_heap_ptr)
+      if constexpr (has_class_traits_prototype<AdaptedT>)
         prototype_heap_ptr = class_traits_prototype<AdaptedT>::get(ctx);
+      else
+        prototype_heap_ptr = find_prototype(ctx, type_id<AdaptedT>());
     }
 
     if (prototype_heap_ptr)
@@ -251,21 +429,33 @@ struct type_traits
       duk_set_prototype(ctx, -2);
     }
 
-    if constexpr (iterable<AdaptedT> || options.iterable)
-      make_iterable<AdaptedT>(ctx, -1);
+    set_object_finalizer(ctx);
+
+    if constexpr (has_class_traits_mirror<AdaptedT>)
+      objInfo->refreshMirror(-1);
+
+    // Objects sharing a prototype share its Symbol.iterator too, so they don't need one of their own.
+    if constexpr (isIterable)
+    {
+      if (prototype_heap_ptr)
+        make_prototype_iterable<AdaptedT>(ctx, prototype_heap_ptr, type_id<AdaptedT>());
+      else
+        make_iterable<AdaptedT>(ctx, -1);
+    }
   }
 
   [[nodiscard]]
   static decltype(auto) get(duk_context* ctx, duk_idx_t idx)
   {
-    // TODO:
-    // Accessing property here isn't ideal since, in most cases, it's already been done in check_type.
-    // I am not sure how bad it is for the performance, but could be significant. Consider optimizing it somehow.
-    scoped_pop _(ctx); // get_prop_string
-    if (!get_prop_string(ctx, idx, type_traits_object_info_name))
-      throw error(ctx, "accessing invalid or finalized object");
+    return get(ctx, idx, get_object_info(ctx, idx));
+  }
 
-    auto objInfo = static_cast<ObjectInfo*>(duk_get_pointer(ctx, -1));
+  // Used when objInfo has already been looked up (e.g. by FunctionWrapper, which shares it with check_type).
+  [[nodiscard]]
+  static decltype(auto) get(duk_context* ctx, [[maybe_unused]] duk_idx_t idx, ObjectInfo* objInfo)
+  {
+    if (!objInfo) [[unlikely]]
+      throw error(ctx, "accessing invalid or finalized object");
 
     return objInfo->get<DecayT>();
   }
@@ -273,31 +463,30 @@ struct type_traits
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
-    if (!duk_is_object(ctx, idx))
-      return false;
-
-    scoped_pop _(ctx); // get_prop_string
-    if (!get_prop_string(ctx, idx, type_traits_object_info_name))
-      return false;
-
-    auto objInfo = static_cast<ObjectInfo*>(duk_get_pointer(ctx, -1));
+    return check_type(ctx, idx, get_object_info(ctx, idx));
+  }
 
-    return objInfo->checkType(type_id<DecayT>());
+  [[nodiscard]]
+  static bool check_type(
+    [[maybe_unused]] duk_context* ctx,
+    [[maybe_unused]] duk_idx_t idx,
+    ObjectInfo* objInfo
+  ) noexcept
+  {
+    return objInfo && objInfo->checkType(type_id<DecayT>());
   }
 };
 
 
 inline bool finalize_object(duk_context* ctx, duk_idx_t idx)
 {
-  scoped_pop _(ctx); // duk_get_prop_string
-  if (!get_prop_string(ctx, idx, type_traits_object_info_name))
+  auto objInfo = get_own_object_info(ctx, idx);
+  if (!objInfo)
     return false;
 
-  auto objInfo = static_cast<ObjectInfo*>(duk_get_pointer(ctx, -1));
-
   objInfo->finalize();
 
-  return del_prop_string(ctx, idx - 1, type_traits_object_info_name);
+  return del_prop_string(ctx, idx, type_traits_object_info_name);
 }
 
 
@@ -305,6 +494,108 @@ inline bool finalize_object(duk_context* ctx, duk_idx_t idx)
 static constexpr auto type_traits_func_info_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("func"));
 
 
+// Type-erased owner of a callable pushed by type_traits<callable>, so all callables can share one finalizer.
+struct FunctionInfo
+{
+  FunctionInfo(duk_context* ctx, void* heapPtr) :
+    ctx_(ctx),
+    heapPtr_(heapPtr)
+  {
+  }
+
+  virtual ~FunctionInfo() = default;
+
+  [[nodiscard]]
+  bool isOwnedBy(void* heapPtr) const noexcept
+  {
+    return heapPtr_ == heapPtr;
+  }
+
+  virtual void finalize() noexcept = 0;
+
+protected:
+  duk_context* ctx_ = nullptr;
+
+private:
+  void* heapPtr_ = nullptr;
+};
+
+
+template<typename Func>
+struct FunctionInfoImpl : FunctionInfo
+{
+  FunctionInfoImpl(duk_context* ctx, void* heapPtr, auto&& func) :
+    FunctionInfo(ctx, heapPtr),
+    func_(std::forward<decltype(func)>(func))
+  {
+  }
+
+  void finalize() noexcept override
+  {
+    free(ctx_, this);
+  }
+
+  Func func_;
+};
+
+
+// Returns nullptr if value at idx isn't a callable pushed by dukcpp (or it's been finalized).
+inline FunctionInfo* get_own_function_info(duk_context* ctx, duk_idx_t idx) noexcept
+{
+  if (!duk_is_function(ctx, idx))
+    return nullptr;
+
+  auto heapPtr = duk_get_heapptr(ctx, idx);
+
+  scoped_pop _(ctx); // get_prop_string
+  if (!get_prop_string(ctx, idx, type_traits_func_info_name))
+    return nullptr;
+
+  auto funcInfo = static_cast<FunctionInfo*>(duk_get_pointer(ctx, -1));
+  if (!funcInfo || !funcInfo->isOwnedBy(heapPtr))
+    return nullptr;
+
+  return funcInfo;
+}
+
+
+static constexpr auto function_finalizer_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("funcFinalizer"));
+
+
+// Detaches callable at idx from its function slot and hidden property, so calls fail instead of reaching finalized
+// functor.
+inline void detach_function_info(duk_context* ctx, duk_idx_t idx) noexcept
+{
+  auto slot = function_slot(duk_get_magic(ctx, idx));
+
+  // Function with a slot means heap state exists already.
+  if (slot != no_function_slot)
+  {
+    duk_set_magic(ctx, idx, 0);
+    release_function_slot(*find_heap_state(ctx), slot);
+  }
+
+  del_prop_string(ctx, idx, type_traits_func_info_name);
+}
+
+
+inline duk_ret_t function_finalizer(duk_context* ctx)
+{
+  expire_weak_slot(ctx, 0);
+
+  auto funcInfo = get_own_function_info(ctx, 0);
+  if (!funcInfo)
+    return 0;
+
+  // Duktape may run the finalizer again for a resurrected function, so functor must be released only once.
+  detach_function_info(ctx, 0);
+
+  funcInfo->finalize();
+
+  return 0;
+}
+
+
 template<callable T>
 struct type_traits<T>
 {
@@ -343,57 +634,74 @@ struct type_traits<T>
   static void push(duk_context* ctx, auto&& func)
   {
     using DecayFunc = std::decay_t<Func>;
+    using FunctionInfoImplT = FunctionInfoImpl<DecayFunc>;
+    using Dispatcher = OverloadDispatcher<DynamicOverloadCandidate<DecayFunc, Signature>...>;
+
+    // Stateless functors (e.g. lambdas without captures) don't need to be stored at all. Any instance will do, so
+    // the wrapper creates one on each call, and skips looking it up.
+    static constexpr bool stateless =
+      std::is_empty_v<DecayFunc> &&
+      std::is_trivially_copyable_v<DecayFunc> &&
+      std::is_default_constructible_v<DecayFunc>;
 
     static constexpr auto wrapper = [](duk_context* ctx) -> duk_ret_t
     {
-      duk_push_current_function(ctx);
+      duk_ret_t result;
 
-      if (!get_prop_string(ctx, -1, type_traits_func_info_name))
-        throw error(ctx, "called invalid or finalized function");
+      if constexpr (stateless)
+      {
+        DecayFunc func{};
 
-      auto funcPtr = static_cast<DecayFunc*>(duk_get_pointer(ctx, -1));
-      duk_pop_2(ctx);
+        result = Dispatcher::run(ctx, &func);
+      }
+      else
+      {
+        FunctionInfo* funcInfo;
 
-      duk_ret_t result;
-      if ((((result =
-        [ctx, funcPtr]()
+        // Magic indexes function slot, unless all slots were taken when the function was pushed.
+        if (auto slot = function_slot(duk_get_current_magic(ctx)); slot != no_function_slot) [[likely]]
+        {
+          funcInfo = get_function_slot(get_heap_state(ctx), slot);
+        }
+        else
         {
-          using ArgsTuple = boost::callable_traits::args_t<Signature>;
+          duk_push_current_function(ctx);
 
-          static constexpr auto argCount = std::tuple_size_v<ArgsTuple>;
+          // Same key as type_traits_func_info_name, but looking it up by literal lets Duktape skip string interning.
+          if (!duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("func")))
+            throw error(ctx, "called invalid or finalized function");
 
-          return FunctionWrapper<
-            Signature, std::make_index_sequence<argCount>, false
-          >::run(ctx, *funcPtr);
-        }()) < 0) && ...))
-      {
-        return duk_error(ctx, DUK_ERR_TYPE_ERROR, "no matching function found");
+          funcInfo = static_cast<FunctionInfo*>(duk_get_pointer(ctx, -1));
+          duk_pop_2(ctx);
+        }
+
+        result = Dispatcher::run(ctx, &static_cast<FunctionInfoImplT*>(funcInfo)->func_);
       }
 
+      if (result < 0)
+        return duk_error(ctx, DUK_ERR_TYPE_ERROR, "no matching function found");
+
       return result;
     };
 
-    static constexpr auto finalizer = [](duk_context* ctx) -> duk_ret_t
-    {
-      if (!get_prop_string(ctx, 0, type_traits_func_info_name))
-        return 0;
-
-      auto funcPtr = static_cast<DecayFunc*>(duk_get_pointer(ctx, -1));
-
-      free(ctx, funcPtr);
+    duk_push_c_function(ctx, wrapper, DUK_VARARGS);
 
-      return 0;
-    };
+    if constexpr (!stateless)
+    {
+      auto* funcInfo = make<FunctionInfoImplT>(ctx, ctx, duk_get_heapptr(ctx, -1), std::forward<decltype(func)>(func));
 
-    auto* funcPtr = make<DecayFunc>(ctx, std::forward<decltype(func)>(func));
+      duk_push_pointer(ctx, static_cast<FunctionInfo*>(funcInfo));
+      put_prop_string(ctx, -2, type_traits_func_info_name);
 
-    duk_push_c_function(ctx, wrapper, DUK_VARARGS);
+      // Functions share Function.prototype, so the finalizer can't be inherited and each of them references it.
+      push_shared_finalizer(ctx, function_finalizer_name, function_finalizer);
+      duk_set_finalizer(ctx, -2);
 
-    duk_push_pointer(ctx, funcPtr);
-    put_prop_string(ctx, -2, type_traits_func_info_name);
+      auto& heapState = get_heap_state(ctx);
 
-    duk_push_c_function(ctx, finalizer, 2);
-    duk_set_finalizer(ctx, -2);
+      if (auto slot = acquire_function_slot(ctx, heapState, funcInfo); slot != no_function_slot) [[likely]]
+        duk_set_magic(ctx, -1, function_slot_magic(slot));
+    }
   }
 
   [[nodiscard]]
@@ -404,6 +712,8 @@ struct type_traits<T>
     return safe_function_handle<Result>(handle(ctx, idx));
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_LIGHTFUNC;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -414,34 +724,49 @@ struct type_traits<T>
 
 inline bool finalize_callable(duk_context* ctx, duk_idx_t idx)
 {
-  scoped_pop _(ctx); // duk_get_prop_string
-  if (!get_prop_string(ctx, idx, type_traits_func_info_name))
+  auto funcInfo = get_own_function_info(ctx, idx);
+  if (!funcInfo)
     return false;
 
-  duk_get_finalizer(ctx, idx - 1);
-  duk_dup(ctx, idx - 2);
+  detach_function_info(ctx, idx);
 
-  scoped_pop __(ctx); // duk_pcall
-  if (duk_pcall(ctx, 1) != DUK_EXEC_SUCCESS)
-    throw duk::es_error(ctx, -1);
+  funcInfo->finalize();
 
-  return del_prop_string(ctx, idx - 2, type_traits_func_info_name);
+  return true;
 }
 
 
 inline bool clone(duk_context* ctx, duk_idx_t idx)
 {
-  ObjectInfo* objInfo = nullptr;
+  auto objInfo = get_object_info(ctx, idx);
+  if (!objInfo)
+    return false;
+
+  objInfo->clone();
+
+  return true;
+}
+
+
+inline bool sync_object(duk_context* ctx, duk_idx_t idx)
+{
+  auto objInfo = get_own_object_info(ctx, idx);
+  if (!objInfo)
+    return false;
 
-  {
-    scoped_pop _(ctx); // duk_get_prop_string
-    if (!get_prop_string(ctx, idx, type_traits_object_info_name))
-      return false;
+  objInfo->syncMirror(idx);
 
-    objInfo = static_cast<ObjectInfo*>(duk_get_pointer(ctx, -1));
-  }
+  return true;
+}
 
-  objInfo->clone();
+
+inline bool refresh_object(duk_context* ctx, duk_idx_t idx)
+{
+  auto objInfo = get_own_object_info(ctx, idx);
+  if (!objInfo)
+    return false;
+
+  objInfo->refreshMirror(idx);
 
   return true;
 }
@@ -456,6 +781,8 @@ struct type_traits<as_iterable<T>>
 
   static constexpr auto options = type_traits_options{ .iterable = true };
 
+  static constexpr duk_uint_t type_mask = type_traits<IterableT, options>::type_mask;
+
   static void push(duk_context* ctx, auto&& obj, void* prototype_heap_ptr = nullptr)
   {
     type_traits<IterableT, options>::push(ctx, std::forward<decltype(obj)>(obj), prototype_heap_ptr);
@@ -467,11 +794,23 @@ struct type_traits<as_iterable<T>>
     return type_traits<IterableT, options>::get(ctx, idx);
   }
 
+  [[nodiscard]]
+  static decltype(auto) get(duk_context* ctx, duk_idx_t idx, ObjectInfo* objInfo)
+  {
+    return type_traits<IterableT, options>::get(ctx, idx, objInfo);
+  }
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
     return type_traits<IterableT, options>::check_type(ctx, idx);
   }
+
+  [[nodiscard]]
+  static bool check_type(duk_context* ctx, duk_idx_t idx, ObjectInfo* objInfo) noexcept
+  {
+    return type_traits<IterableT, options>::check_type(ctx, idx, objInfo);
+  }
 };
 
 
@@ -484,6 +823,8 @@ struct type_traits<array_input_range<Ts...>>
     return { ctx, idx };
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -501,6 +842,8 @@ struct type_traits<symbol_input_range<Ts...>>
     return { ctx, idx };
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_BUFFER | DUK_TYPE_MASK_LIGHTFUNC;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -518,6 +861,8 @@ struct type_traits<input_range<Ts...>>
     return { ctx, idx };
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_BUFFER | DUK_TYPE_MASK_LIGHTFUNC;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -526,6 +871,218 @@ struct type_traits<input_range<Ts...>>
 };
 
 
+template<typename T>
+struct type_traits<array_snapshot<T>>
+{
+  [[nodiscard]]
+  static array_snapshot<T> get(duk_context* ctx, duk_idx_t idx)
+  {
+    return { ctx, idx };
+  }
+
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT;
+
+  [[nodiscard]]
+  static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
+  {
+    return duk_is_array(ctx, idx);
+  }
+};
+
+
+static constexpr auto type_traits_buffer_info_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("buf"));
+static constexpr auto type_traits_buffer_data_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("bufData"));
+
+
+// Type-erased owner of a container viewed by an ArrayBuffer pushed by type_traits<typed_array>.
+struct BufferInfo
+{
+  BufferInfo(duk_context* ctx, void* heapPtr) :
+    ctx_(ctx),
+    heapPtr_(heapPtr)
+  {
+  }
+
+  virtual ~BufferInfo() = default;
+
+  [[nodiscard]]
+  bool isOwnedBy(void* heapPtr) const noexcept
+  {
+    return heapPtr_ == heapPtr;
+  }
+
+  virtual void finalize() noexcept = 0;
+
+protected:
+  duk_context* ctx_ = nullptr;
+
+private:
+  void* heapPtr_ = nullptr;
+};
+
+
+template<typename Container>
+struct BufferInfoImpl : BufferInfo
+{
+  BufferInfoImpl(duk_context* ctx, void* heapPtr, Container&& container) :
+    BufferInfo(ctx, heapPtr),
+    container_(std::move(container))
+  {
+  }
+
+  void finalize() noexcept override
+  {
+    free(ctx_, this);
+  }
+
+  Container container_;
+};
+
+
+static constexpr auto buffer_finalizer_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("bufFinalizer"));
+
+
+inline duk_ret_t buffer_finalizer(duk_context* ctx)
+{
+  expire_weak_slot(ctx, 0);
+
+  auto heapPtr = duk_get_heapptr(ctx, 0);
+
+  if (!get_prop_string(ctx, 0, type_traits_buffer_info_name))
+    return 0;
+
+  auto bufInfo = static_cast<BufferInfo*>(duk_get_pointer(ctx, -1));
+  if (!bufInfo || !bufInfo->isOwnedBy(heapPtr))
+    return 0;
+
+  // Duktape may run the finalizer again for a resurrected object, so storage must be released only once.
+  duk_push_pointer(ctx, nullptr);
+  put_prop_string(ctx, 0, type_traits_buffer_info_name);
+
+  // Views may still be reachable (e.g. resurrected, or finalizer called directly), so the external buffer is detached
+  // before storage is released. Its views then read as out of bounds instead of touching freed memory.
+  if (get_prop_string(ctx, 0, type_traits_buffer_data_name))
+    duk_config_buffer(ctx, -1, nullptr, 0);
+
+  bufInfo->finalize();
+
+  return 0;
+}
+
+
+// Typed array views an external buffer pointing to storage of the container, which is owned by the ArrayBuffer
+// backing the view. Views derived from it (subarray, new views over .buffer) reference the same ArrayBuffer, so the
+// storage outlives all of them.
+template<typed_array_container Container>
+struct type_traits<typed_array<Container>>
+{
+  using ElementT = std::ranges::range_value_t<Container>;
+
+  static void push(duk_context* ctx, auto&& array)
+  {
+    auto container = std::forward<decltype(array)>(array).release();
+    auto bytes = std::ranges::size(container) * sizeof(ElementT);
+
+    duk_push_external_buffer(ctx);
+    duk_push_buffer_object(ctx, -1, 0, bytes, DUK_BUFOBJ_ARRAYBUFFER);
+    duk_push_buffer_object(ctx, -1, 0, bytes, typed_array_traits<ElementT>::type);
+
+    // Container is moved into heap-allocated storage first, so data pointer stays valid from now on.
+    auto bufInfo = make<BufferInfoImpl<Container>>(ctx, ctx, duk_get_heapptr(ctx, -2), std::move(container));
+
+    duk_push_pointer(ctx, static_cast<BufferInfo*>(bufInfo));
+    put_prop_string(ctx, -3, type_traits_buffer_info_name);
+
+    // ArrayBuffer doesn't expose its plain buffer, so it's kept for the finalizer to detach.
+    duk_dup(ctx, -3);
+    put_prop_string(ctx, -3, type_traits_buffer_data_name);
+
+    push_shared_finalizer(ctx, buffer_finalizer_name, buffer_finalizer);
+    duk_set_finalizer(ctx, -3);
+
+    duk_config_buffer(ctx, -3, const_cast<ElementT*>(std::ranges::data(bufInfo->container_)), bytes);
+
+    duk_replace(ctx, -3);
+    duk_pop(ctx); // Pop ArrayBuffer
+  }
+};
+
+
+// Spans map directly onto backing store of typed arrays with matching element type, so no elements are copied.
+template<typed_array_element T>
+struct type_traits<std::span<T>>
+{
+  using ElementT = std::remove_const_t<T>;
+
+  // Spans don't own their elements, so they're copied into a new typed array. See typed_array for zero-copy push.
+  static void push(duk_context* ctx, std::span<T> values)
+  {
+    auto bytes = values.size_bytes();
+    auto data = duk_push_fixed_buffer(ctx, bytes);
+
+    if (bytes > 0)
+      std::memcpy(data, values.data(), bytes);
+
+    duk_push_buffer_object(ctx, -1, 0, bytes, typed_array_traits<ElementT>::type);
+    duk_remove(ctx, -2); // Remove plain buffer
+  }
+
+  [[nodiscard]]
+  static std::span<T> get(duk_context* ctx, duk_idx_t idx)
+  {
+    duk_size_t size = 0;
+    auto data = duk_get_buffer_data(ctx, idx, &size);
+
+    return { static_cast<T*>(data), size / sizeof(T) };
+  }
+
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_BUFFER;
+
+  [[nodiscard]]
+  static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
+  {
+    static constexpr auto type = typed_array_traits<ElementT>::type;
+
+    if (!is_typed_array(ctx, idx, type))
+    {
+      if constexpr (type != DUK_BUFOBJ_UINT8ARRAY)
+        return false;
+      else if (!is_typed_array(ctx, idx, DUK_BUFOBJ_UINT8CLAMPEDARRAY))
+        return false;
+    }
+
+    duk_size_t size = 0;
+    auto data = duk_get_buffer_data(ctx, idx, &size);
+
+    return reinterpret_cast<std::uintptr_t>(data) % alignof(T) == 0 && size % sizeof(T) == 0;
+  }
+};
+
+
+// Byte spans accept any buffer data (plain buffers, ArrayBuffers, DataViews and typed arrays).
+template<typename T>
+requires std::is_same_v<std::remove_const_t<T>, std::byte>
+struct type_traits<std::span<T>>
+{
+  [[nodiscard]]
+  static std::span<T> get(duk_context* ctx, duk_idx_t idx)
+  {
+    duk_size_t size = 0;
+    auto data = duk_get_buffer_data(ctx, idx, &size);
+
+    return { static_cast<T*>(data), size };
+  }
+
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_OBJECT | DUK_TYPE_MASK_BUFFER;
+
+  [[nodiscard]]
+  static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
+  {
+    return duk_is_buffer_data(ctx, idx);
+  }
+};
+
+
 template<handle_type T>
 struct type_traits<T>
 {
@@ -554,6 +1111,8 @@ struct type_traits<T>
     return duk_get_int(ctx, idx);
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_NUMBER;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -577,6 +1136,8 @@ struct type_traits<T>
     return duk_get_uint(ctx, idx);
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_NUMBER;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -599,6 +1160,8 @@ struct type_traits<T>
     return duk_get_number(ctx, idx);
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_NUMBER;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -621,6 +1184,8 @@ struct type_traits<T>
     return duk_get_boolean(ctx, idx);
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_BOOLEAN;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -646,6 +1211,8 @@ struct type_traits<T>
     return static_cast<DecayT>(type_traits<IntT>::get(ctx, idx));
   }
 
+  static constexpr duk_uint_t type_mask = type_traits<IntT>::type_mask;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -675,6 +1242,8 @@ struct type_traits<T>
     return string_traits<DecayT>::make_string(string, size);
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_STRING;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -695,6 +1264,8 @@ struct type_traits<void>
     // Do nothing.
   }
 
+  static constexpr duk_uint_t type_mask = DUK_TYPE_MASK_UNDEFINED;
+
   [[nodiscard]]
   static bool check_type(duk_context* ctx, duk_idx_t idx) noexcept
   {
@@ -0,0 +1,123 @@
+#ifndef DUKCPP_DETAIL_TYPED_ARRAY_H
+#define DUKCPP_DETAIL_TYPED_ARRAY_H
+
+#include <duk/common.h>
+#include <duk/detail/heap_state.h>
+#include <duktape.h>
+#include <cstdint>
+#include <type_traits>
+
+
+namespace duk::detail
+{
+
+
+// Maps arithmetic types to built-in typed arrays (DUK_BUFOBJ_* constants) with matching elements.
+template<typename T>
+struct typed_array_traits;
+
+template<>
+struct typed_array_traits<std::int8_t>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_INT8ARRAY;
+};
+
+template<>
+struct typed_array_traits<std::uint8_t>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_UINT8ARRAY;
+};
+
+template<>
+struct typed_array_traits<std::int16_t>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_INT16ARRAY;
+};
+
+template<>
+struct typed_array_traits<std::uint16_t>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_UINT16ARRAY;
+};
+
+template<>
+struct typed_array_traits<std::int32_t>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_INT32ARRAY;
+};
+
+template<>
+struct typed_array_traits<std::uint32_t>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_UINT32ARRAY;
+};
+
+template<>
+struct typed_array_traits<float>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_FLOAT32ARRAY;
+};
+
+template<>
+struct typed_array_traits<double>
+{
+  static constexpr duk_uint_t type = DUK_BUFOBJ_FLOAT64ARRAY;
+};
+
+
+template<typename T>
+concept typed_array_element = requires
+{
+  typed_array_traits<std::remove_const_t<T>>::type;
+};
+
+
+// Returns heap pointer of the built-in prototype of given typed array type. Buffer objects pushed through the API get
+// built-in prototypes, whatever script code did to the global constructors, so the prototype is taken from one of them.
+// Built-in prototypes are referenced by the heap itself, so they don't need to be kept reachable.
+[[nodiscard]]
+inline void* get_typed_array_prototype(duk_context* ctx, duk_uint_t type)
+{
+  auto& heapState = get_heap_state(ctx);
+  auto& prototype = heapState.typedArrayPrototypes[type];
+
+  if (prototype) [[likely]]
+    return prototype;
+
+  duk_push_fixed_buffer(ctx, 0);
+  duk_push_buffer_object(ctx, -1, 0, 0, type);
+  duk_get_prototype(ctx, -1);
+  prototype = duk_get_heapptr(ctx, -1);
+  duk_pop_3(ctx); // Pop prototype, typed array and plain buffer
+
+  return prototype;
+}
+
+
+// Checks whether value at idx is a typed array of given type. Plain buffers are treated as Uint8Arrays.
+//
+// Typed array is told by its prototype, like bound C++ objects are, so a buffer object whose prototype was replaced by
+// script code with another typed array's one is accepted as that typed array. Its data is still accessed within its
+// bounds (see type_traits<std::span>).
+[[nodiscard]]
+inline bool is_typed_array(duk_context* ctx, duk_idx_t idx, duk_uint_t type)
+{
+  if (duk_is_buffer(ctx, idx))
+    return type == DUK_BUFOBJ_UINT8ARRAY;
+
+  // Only buffer objects are checked further, so builds without buffer object support never push one.
+  if (!duk_is_buffer_data(ctx, idx))
+    return false;
+
+  duk_get_prototype(ctx, idx);
+  auto prototype = duk_get_heapptr(ctx, -1);
+  duk_pop(ctx);
+
+  return prototype && prototype == get_typed_array_prototype(ctx, type);
+}
+
+
+} // namespace duk::detail
+
+
+#endif // DUKCPP_DETAIL_TYPED_ARRAY_H
@@ -7,8 +7,12 @@
 
 #include <duk/allocator.h>
 #include <duk/allocator_adapter.h>
+#include <duk/array_output.h>
+#include <duk/array_snapshot.h>
+#include <duk/batch_call.h>
 #include <duk/callable.h>
 #include <duk/class.h>
+#include <duk/class_builder.h>
 #include <duk/common.h>
 #include <duk/context.h>
 #include <duk/detail/memory_resource.h>
@@ -16,11 +20,19 @@
 #include <duk/enum_helpers.h>
 #include <duk/error.h>
 #include <duk/handle.h>
+#include <duk/handle_vector.h>
 #include <duk/iterable.h>
+#include <duk/method_handle.h>
+#include <duk/prepared_call.h>
 #include <duk/type_traits_helpers.h>
 #include <duk/function_handle.h>
 #include <duk/function_helpers.h>
+#include <duk/generator.h>
 #include <duk/property_helpers.h>
+#include <duk/prototype_helpers.h>
 #include <duk/safe_handle.h>
+#include <duk/thread_safe_handle.h>
+#include <duk/typed_array.h>
+#include <duk/weak_handle.h>
 
 #endif // DUKCPP_DUK_H
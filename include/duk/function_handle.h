@@ -1,12 +1,15 @@
 #ifndef DUKCPP_FUNCTION_HANDLE_H
 #define DUKCPP_FUNCTION_HANDLE_H
 
+#include <duk/callable.h>
 #include <duk/common.h>
 #include <duk/handle.h>
 #include <duk/safe_handle.h>
 #include <duk/scoped_pop.h>
+#include <duk/thread_safe_handle.h>
 #include <duk/type_traits_helpers.h>
 #include <duktape.h>
+#include <type_traits>
 
 
 namespace duk
@@ -31,12 +34,24 @@ public:
     (push(ctx, std::forward<decltype(args)>(args)), ...);
 
     scoped_pop _(ctx); // duk_pcall
-    if (duk_pcall(ctx, sizeof...(args)) != DUK_EXEC_SUCCESS)
+    auto result = duk_pcall(ctx, sizeof...(args));
+
+    // Returning from an ES call is a safe point for releasing objects queued by other threads.
+    if constexpr (std::is_same_v<Handle, thread_safe_handle>)
+      drain_releases(handle_);
+
+    if (result != DUK_EXEC_SUCCESS)
       throw duk::es_error(ctx, -1);
 
     return safe_get<Result>(ctx, -1);
   }
 
+  [[nodiscard]]
+  const Handle& get() const noexcept
+  {
+    return handle_;
+  }
+
 private:
   Handle handle_;
 };
@@ -47,6 +62,11 @@ template<typename T>
 using safe_function_handle = function_handle<T, safe_handle>;
 
 
+// Owning handle to Duktape function, which may be copied and destroyed on any thread (see thread_safe_handle).
+template<typename T>
+using thread_safe_function_handle = function_handle<T, thread_safe_handle>;
+
+
 template<typename T, typename ...Ts>
 struct callable_traits_type<function_handle<T, Ts...>>
 {
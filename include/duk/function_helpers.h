@@ -97,6 +97,60 @@ void put_prop_method(duk_context* ctx, duk_idx_t idx, std::string_view name)
 }
 
 
+// Lightweight function variants.
+//
+// Functions known at compile time don't carry any state, so they can be pushed as Duktape lightfuncs. Lightfuncs are
+// tagged values, not objects, so binding them costs no heap memory at all. On the other hand, they can't have own
+// properties (e.g. a "prototype" used by constructor calls), and every access to their virtual properties (name,
+// length) creates them on the fly. See https://duktape.org/guide#lightfuncs.
+
+template<typename ...FuncDesc>
+duk_idx_t push_light_function(duk_context* ctx)
+{
+  static constexpr auto funcWrapper = detail::overloadedFunctionWrapper<FuncDesc...>;
+
+  return duk_push_c_lightfunc(ctx, funcWrapper, DUK_VARARGS, 0, 0);
+}
+
+
+template<auto ...Func>
+duk_idx_t push_light_function(duk_context* ctx)
+{
+  return push_light_function<function_descriptor<Func, decltype(Func)>...>(ctx);
+}
+
+
+template<auto ...Func>
+duk_idx_t push_light_method(duk_context* ctx)
+{
+  return push_light_function<function_descriptor<Func, detail::to_method_signature_t<decltype(Func)>>...>(ctx);
+}
+
+
+template<typename ...FuncDesc>
+void put_prop_light_function(duk_context* ctx, duk_idx_t idx, std::string_view name)
+{
+  push_light_function<FuncDesc...>(ctx);
+  duk_put_prop_lstring(ctx, idx - 1, name.data(), name.length());
+}
+
+
+template<auto ...Func>
+void put_prop_light_function(duk_context* ctx, duk_idx_t idx, std::string_view name)
+{
+  push_light_function<Func...>(ctx);
+  duk_put_prop_lstring(ctx, idx - 1, name.data(), name.length());
+}
+
+
+template<auto ...Func>
+void put_prop_light_method(duk_context* ctx, duk_idx_t idx, std::string_view name)
+{
+  push_light_method<Func...>(ctx);
+  duk_put_prop_lstring(ctx, idx - 1, name.data(), name.length());
+}
+
+
 template<typename ...Signature>
 void push_function(duk_context* ctx, auto&& func)
 {
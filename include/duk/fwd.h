@@ -20,11 +20,22 @@ struct type_traits_options
 template<typename T, type_traits_options options = type_traits_options{}>
 struct type_traits;
 
+struct ObjectInfo;
+
+ObjectInfo* get_object_info(duk_context* ctx, duk_idx_t idx) noexcept;
+
+struct RangeCursor;
+
+RangeCursor* make_range_cursor(duk_context* ctx, duk_idx_t objIdx, duk_idx_t iterFuncIdx);
+
 bool finalize_object(duk_context* ctx, duk_idx_t idx);
 bool finalize_callable(duk_context* ctx, duk_idx_t idx);
 
 bool clone(duk_context* ctx, duk_idx_t idx);
 
+bool sync_object(duk_context* ctx, duk_idx_t idx);
+bool refresh_object(duk_context* ctx, duk_idx_t idx);
+
 
 } // namespace detail
 
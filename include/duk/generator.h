@@ -0,0 +1,227 @@
+#ifndef DUKCPP_GENERATOR_H
+#define DUKCPP_GENERATOR_H
+
+#include <duk/iterable.h>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+
+namespace duk
+{
+
+
+// Coroutine producing a sequence of values on demand.
+//
+// Generators are iterable, so when pushed (e.g. returned from a bound function), ES code can iterate them with
+// [Symbol.iterator]. Coroutine runs up to its first value when iteration starts, and then every call to next resumes
+// it once. Generators are single-pass, so all iterators of a generator share its progress.
+//
+// static constexpr auto scan = [](std::string path) -> duk::generator<std::string>
+// {
+//   for (auto reader = Reader(path); reader; reader.next())
+//     co_yield reader.line();
+// };
+template<typename T>
+class generator final
+{
+public:
+  using value_type = std::remove_cvref_t<T>;
+  using reference = std::conditional_t<std::is_reference_v<T>, T, T&>;
+
+  struct promise_type
+  {
+    [[nodiscard]]
+    generator get_return_object() noexcept
+    {
+      return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    [[nodiscard]]
+    std::suspend_always initial_suspend() const noexcept
+    {
+      return {};
+    }
+
+    [[nodiscard]]
+    std::suspend_always final_suspend() const noexcept
+    {
+      return {};
+    }
+
+    // Yielded value stays alive until the coroutine is resumed, so it doesn't need to be copied.
+    std::suspend_always yield_value(std::remove_reference_t<T>& value) noexcept
+    {
+      value_ = std::addressof(value);
+
+      return {};
+    }
+
+    std::suspend_always yield_value(std::remove_reference_t<T>&& value) noexcept
+    {
+      value_ = std::addressof(value);
+
+      return {};
+    }
+
+    // Const lvalue can't be referred to by a mutable reference, so it's copied into the promise and stays there until
+    // the next value is yielded.
+    std::suspend_always yield_value(const std::remove_reference_t<T>& value)
+      requires (!std::is_reference_v<T> && !std::is_const_v<T> && std::is_copy_constructible_v<T>)
+    {
+      value_ = std::addressof(copy_.emplace(value));
+
+      return {};
+    }
+
+    void return_void() const noexcept
+    {
+    }
+
+    void unhandled_exception() noexcept
+    {
+      exception_ = std::current_exception();
+    }
+
+    // Generators can only yield.
+    template<typename U>
+    std::suspend_never await_transform(U&&) = delete;
+
+  private:
+    friend class generator;
+
+    std::remove_reference_t<T>* value_ = nullptr;
+    // Reference generators never copy, and may refer to types which can't be stored (e.g. abstract classes).
+    std::optional<std::conditional_t<std::is_reference_v<T>, std::nullptr_t, value_type>> copy_;
+    std::exception_ptr exception_;
+    bool started_ = false;
+  };
+
+  class iterator final
+  {
+  public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = generator::value_type;
+
+    iterator() = default;
+
+    [[nodiscard]]
+    reference operator*() const noexcept
+    {
+      return static_cast<reference>(*coroutine_.promise().value_);
+    }
+
+    iterator& operator++()
+    {
+      resume(coroutine_);
+
+      return *this;
+    }
+
+    void operator++(int)
+    {
+      operator++();
+    }
+
+    [[nodiscard]]
+    bool operator==(std::default_sentinel_t) const noexcept
+    {
+      return !coroutine_ || coroutine_.done();
+    }
+
+  private:
+    friend class generator;
+
+    explicit iterator(std::coroutine_handle<promise_type> coroutine) noexcept :
+      coroutine_(coroutine)
+    {
+    }
+
+    std::coroutine_handle<promise_type> coroutine_;
+  };
+
+  generator(const generator&) = delete;
+
+  generator(generator&& other) noexcept :
+    coroutine_(std::exchange(other.coroutine_, nullptr))
+  {
+  }
+
+  ~generator()
+  {
+    if (coroutine_)
+      coroutine_.destroy();
+  }
+
+  generator& operator=(const generator&) = delete;
+
+  generator& operator=(generator&& other) noexcept
+  {
+    if (this != &other)
+    {
+      if (coroutine_)
+        coroutine_.destroy();
+
+      coroutine_ = std::exchange(other.coroutine_, nullptr);
+    }
+
+    return *this;
+  }
+
+  // First call runs the coroutine up to its first value. Following calls return iterator at the current position.
+  [[nodiscard]]
+  iterator begin()
+  {
+    if (coroutine_ && !coroutine_.promise().started_)
+    {
+      coroutine_.promise().started_ = true;
+      resume(coroutine_);
+    }
+
+    return iterator(coroutine_);
+  }
+
+  [[nodiscard]]
+  std::default_sentinel_t end() const noexcept
+  {
+    return {};
+  }
+
+private:
+  explicit generator(std::coroutine_handle<promise_type> coroutine) noexcept :
+    coroutine_(coroutine)
+  {
+  }
+
+  // Exception thrown by the coroutine is rethrown by whoever resumed it.
+  static void resume(std::coroutine_handle<promise_type> coroutine)
+  {
+    if (coroutine.done()) [[unlikely]]
+      return;
+
+    coroutine.resume();
+
+    if (coroutine.done() && coroutine.promise().exception_)
+      std::rethrow_exception(std::exchange(coroutine.promise().exception_, nullptr));
+  }
+
+  std::coroutine_handle<promise_type> coroutine_;
+};
+
+
+template<typename T>
+struct iterable_traits_type<generator<T>>
+{
+  using type = generator<T>;
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_GENERATOR_H
@@ -0,0 +1,129 @@
+#ifndef DUKCPP_HANDLE_VECTOR_H
+#define DUKCPP_HANDLE_VECTOR_H
+
+#include <duk/allocator.h>
+#include <duk/handle.h>
+#include <duk/safe_handle.h>
+#include <duk/scoped_pop.h>
+#include <duktape.h>
+#include <cstddef>
+#include <vector>
+
+
+namespace duk
+{
+
+
+// Owning collection of handles to Duktape heap values.
+//
+// Instead of pinning every value separately (as safe_handle does), all of them are kept reachable by a single array,
+// which is the only pinned value. Erasing moves the last value into the erased position, so it doesn't preserve order,
+// but it's O(1). Clearing (or destroying) the collection releases all values at once.
+class handle_vector final
+{
+public:
+  explicit handle_vector(duk_context* ctx) :
+    heapPtrs_(allocator<void*>(ctx))
+  {
+    scoped_pop _(ctx); // duk_push_bare_array
+    duk_push_bare_array(ctx);
+
+    array_ = safe_handle(handle(ctx, -1));
+  }
+
+  handle_vector(const handle_vector&) = delete;
+  handle_vector(handle_vector&&) noexcept = default;
+
+  handle_vector& operator=(const handle_vector&) = delete;
+  handle_vector& operator=(handle_vector&&) noexcept = default;
+
+  [[nodiscard]]
+  handle operator[](std::size_t pos) const noexcept
+  {
+    return handle(ctx(), heapPtrs_[pos]);
+  }
+
+  [[nodiscard]]
+  std::size_t size() const noexcept
+  {
+    return heapPtrs_.size();
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept
+  {
+    return heapPtrs_.empty();
+  }
+
+  [[nodiscard]]
+  duk_context* ctx() const noexcept
+  {
+    return array_.ctx();
+  }
+
+  void reserve(std::size_t capacity)
+  {
+    heapPtrs_.reserve(capacity);
+  }
+
+  void push_back(const handle& handle)
+  {
+    auto ctx = this->ctx();
+
+    heapPtrs_.push_back(handle.heap_ptr());
+
+    scoped_pop _(ctx); // push_handle
+    push_handle(array_);
+
+    push_handle(handle);
+    duk_put_prop_index(ctx, -2, static_cast<duk_uarridx_t>(heapPtrs_.size() - 1));
+  }
+
+  // Moves the last value into pos.
+  void erase(std::size_t pos)
+  {
+    auto ctx = this->ctx();
+    auto last = heapPtrs_.size() - 1;
+
+    scoped_pop _(ctx); // push_handle
+    push_handle(array_);
+
+    if (pos != last)
+    {
+      heapPtrs_[pos] = heapPtrs_[last];
+
+      duk_push_heapptr(ctx, heapPtrs_[pos]);
+      duk_put_prop_index(ctx, -2, static_cast<duk_uarridx_t>(pos));
+    }
+
+    heapPtrs_.pop_back();
+    duk_set_length(ctx, -1, heapPtrs_.size());
+  }
+
+  void pop_back()
+  {
+    erase(heapPtrs_.size() - 1);
+  }
+
+  void clear()
+  {
+    auto ctx = this->ctx();
+
+    heapPtrs_.clear();
+
+    scoped_pop _(ctx); // push_handle
+    push_handle(array_);
+
+    duk_set_length(ctx, -1, 0);
+  }
+
+private:
+  safe_handle array_;
+  std::vector<void*, allocator<void*>> heapPtrs_;
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_HANDLE_VECTOR_H
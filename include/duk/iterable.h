@@ -1,10 +1,16 @@
 #ifndef DUKCPP_ITERABLE_H
 #define DUKCPP_ITERABLE_H
 
+#include <duk/detail/range_cursor.h>
+#include <duk/detail/range_iterator.h>
 #include <duk/function_helpers.h>
 #include <duk/safe_handle.h>
+#include <duk/scoped_pop.h>
 #include <duk/type_traits_helpers.h>
+#include <cstddef>
+#include <cstdint>
 #include <ranges>
+#include <string_view>
 
 
 namespace duk
@@ -46,36 +52,56 @@ struct iterable_traits_type<as_iterable<T>>
 
 // make_iterable
 
+// Object gets a Symbol.iterator function creating native iterator objects. All of them share one prototype (holding
+// the only next function), and each one reuses its result object, so iterating allocates the same number of objects
+// regardless of range size. Note that a result object returned by next is updated by the following call.
 template<typename T>
 void make_iterable(duk_context* ctx, duk_idx_t idx)
 {
-  put_prop_function(ctx, idx, DUK_WELLKNOWN_SYMBOL("Symbol.iterator"),
-    [ctx]()
-    {
-      duk_push_this(ctx);
-      auto hnd = safe_handle({ctx, -1});
-      auto range = std::ranges::subrange(get<T&>(hnd.ctx(), -1));
-
-      duk_push_object(ctx);
-      put_prop_function(ctx, -1, "next",
-        [hnd, range]() mutable
-        {
-          duk_push_object(hnd.ctx());
-          put_prop(hnd.ctx(), -1, "done", range.begin() == range.end());
-          if (range.begin() != range.end())
-          {
-            put_prop(hnd.ctx(), -1, "value", *range.begin());
-            range.advance(1);
-          }
-          return handle(hnd.ctx(), -1);
-        }
-      );
-      return handle(hnd.ctx(), -1);
-    }
-  );
+  idx = duk_normalize_index(ctx, idx);
+
+  duk_push_c_function(ctx, detail::range_iterator_factory<T>, 0);
+
+  duk_push_true(ctx);
+  duk_put_prop_lstring(ctx, -2, detail::range_iterator_marker_name.data(), detail::range_iterator_marker_name.length());
+
+  duk_put_prop_literal(ctx, idx, DUK_WELLKNOWN_SYMBOL("Symbol.iterator"));
 }
 
 
+namespace detail
+{
+
+
+static constexpr auto iterable_type_name = std::string_view(DUKCPP_DETAIL_INTERNAL_NAME("iterableType"));
+
+
+// Makes a prototype shared by objects of type T (identified by typeId) iterable, unless it's been done already. Type id
+// is stored in the prototype, so prototypes of derived types don't mistake inherited Symbol.iterator for their own.
+template<typename T>
+void make_prototype_iterable(duk_context* ctx, void* prototype_heap_ptr, std::size_t typeId)
+{
+  auto typeIdPtr = reinterpret_cast<void*>(static_cast<std::uintptr_t>(typeId));
+
+  scoped_pop _(ctx); // duk_push_heapptr
+  duk_push_heapptr(ctx, prototype_heap_ptr);
+
+  {
+    scoped_pop __(ctx); // get_prop_string
+    if (get_prop_string(ctx, -1, iterable_type_name) && duk_get_pointer(ctx, -1) == typeIdPtr) [[likely]]
+      return;
+  }
+
+  make_iterable<T>(ctx, -1);
+
+  duk_push_pointer(ctx, typeIdPtr);
+  put_prop_string(ctx, -2, iterable_type_name);
+}
+
+
+} // namespace detail
+
+
 } // namespace duk
 
 
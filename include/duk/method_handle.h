@@ -0,0 +1,84 @@
+#ifndef DUKCPP_METHOD_HANDLE_H
+#define DUKCPP_METHOD_HANDLE_H
+
+#include <duk/error.h>
+#include <duk/handle.h>
+#include <duk/safe_handle.h>
+#include <duk/scoped_pop.h>
+#include <duk/type_traits_helpers.h>
+#include <duktape.h>
+#include <string_view>
+#include <utility>
+
+
+namespace duk
+{
+
+
+// Handle to an ES method, called by name on any object.
+//
+// Method name is interned once, and the resulting string stays pinned for as long as the handle exists, so calls push
+// it by heap pointer instead of looking it up in the string table.
+//
+// Method is called on the context of the object's handle, which may be any Duktape thread of the heap the name was
+// interned in. Objects of other heaps are rejected.
+//
+// auto onEvent = duk::method_handle<void>(ctx, "onEvent");
+// onEvent(pluginHandle, event);
+template<typename Result>
+class method_handle
+{
+public:
+  method_handle(duk_context* ctx, std::string_view name)
+  {
+    scoped_pop _(ctx, 2); // duk_push_lstring, duk_push_heap_stash
+    duk_push_lstring(ctx, name.data(), name.length());
+
+    key_ = safe_handle(handle(ctx, -1));
+
+    duk_push_heap_stash(ctx);
+    heapStash_ = duk_get_heapptr(ctx, -1);
+  }
+
+  decltype(auto) operator()(const handle_type auto& obj, auto&& ...args) const
+  {
+    auto ctx = obj.ctx();
+
+    // Threads of a heap share its stash.
+    if (ctx != key_.ctx())
+    {
+      duk_push_heap_stash(ctx);
+      auto heapStash = duk_get_heapptr(ctx, -1);
+      duk_pop(ctx);
+
+      if (heapStash != heapStash_) [[unlikely]]
+        throw error(ctx, "method called on object of another heap");
+    }
+
+    push_handle(obj);
+    duk_push_heapptr(ctx, key_.heap_ptr());
+    (push(ctx, std::forward<decltype(args)>(args)), ...);
+
+    scoped_pop _(ctx, 2); // push_handle, duk_pcall_prop
+    if (duk_pcall_prop(ctx, -static_cast<duk_idx_t>(sizeof...(args) + 2), sizeof...(args)) != DUK_EXEC_SUCCESS)
+      throw duk::es_error(ctx, -1);
+
+    return safe_get<Result>(ctx, -1);
+  }
+
+  [[nodiscard]]
+  duk_context* ctx() const noexcept
+  {
+    return key_.ctx();
+  }
+
+private:
+  safe_handle key_;
+  void* heapStash_ = nullptr;
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_METHOD_HANDLE_H
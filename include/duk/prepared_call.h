@@ -0,0 +1,90 @@
+#ifndef DUKCPP_PREPARED_CALL_H
+#define DUKCPP_PREPARED_CALL_H
+
+#include <duk/error.h>
+#include <duk/handle.h>
+#include <duk/safe_handle.h>
+#include <duk/scoped_pop.h>
+#include <duk/type_traits_helpers.h>
+#include <duktape.h>
+#include <type_traits>
+#include <utility>
+
+
+namespace duk
+{
+
+
+struct prepared_call_options
+{
+  // Unchecked calls skip result type check, so a result of unexpected type is undefined behavior (same as with get).
+  bool check_result = true;
+};
+
+
+template<typename Signature, prepared_call_options options = prepared_call_options{}>
+class prepared_call;
+
+
+// Owning handle to Duktape function, prepared for frequent calls from C++.
+//
+// Argument and result types are fixed by the signature, so arguments are converted before the call, and result
+// conversion is known at compile time. Duktape reserves value stack per activation, so stack space needed by the call
+// is required on every call, from whichever activation makes it.
+//
+// duk::prepared_call<int(int, int), { .check_result = false }> add(duk::handle(ctx, -1));
+// auto sum = add(1, 2);
+template<typename Result, typename ...Args, prepared_call_options options>
+class prepared_call<Result(Args...), options>
+{
+public:
+  static constexpr duk_idx_t stack_size = sizeof...(Args) + 1;
+
+  prepared_call(const handle& handle) :
+    func_(handle)
+  {
+    auto ctx = func_.ctx();
+
+    scoped_pop _(ctx); // push_handle
+    push_handle(func_);
+
+    if (!duk_is_function(ctx, -1)) [[unlikely]]
+      throw error(ctx, "prepared call target isn't a function");
+  }
+
+  Result operator()(Args... args) const
+  {
+    auto ctx = func_.ctx();
+
+    duk_require_stack(ctx, stack_size);
+
+    duk_push_heapptr(ctx, func_.heap_ptr());
+    (push(ctx, std::forward<Args>(args)), ...);
+
+    scoped_pop _(ctx); // duk_pcall
+    if (duk_pcall(ctx, sizeof...(Args)) != DUK_EXEC_SUCCESS) [[unlikely]]
+      throw duk::es_error(ctx, -1);
+
+    if constexpr (std::is_void_v<Result>)
+      return;
+    else if constexpr (options.check_result)
+      return duk::safe_get<Result>(ctx, -1);
+    else
+      return duk::get<Result>(ctx, -1);
+  }
+
+  [[nodiscard]]
+  const safe_handle& get() const noexcept
+  {
+    return func_;
+  }
+
+private:
+  safe_handle func_;
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_PREPARED_CALL_H
@@ -1,8 +1,14 @@
 #ifndef DUKCPP_PROPERTY_HELPERS_H
 #define DUKCPP_PROPERTY_HELPERS_H
 
-#include <boost/callable_traits.hpp>
 #include <duk/common.h>
+#include <duk/detail/function_wrapper.h>
+#include <boost/callable_traits.hpp>
+#include <duktape.h>
+#include <functional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 
 
 namespace duk
@@ -42,6 +48,82 @@ duk_idx_t push_prop_accessor(duk_context* ctx)
 }
 
 
+// Accessors taking `this` object (getters), or `this` object and a value (setters), don't need overload resolution.
+// They get dedicated thunks with fixed argument count, so Duktape drops the property key passed to accessors, and
+// `this` is read without reordering the value stack.
+template<auto Accessor, std::size_t ArgCount>
+concept fixed_arity_accessor =
+  std::tuple_size_v<boost::callable_traits::args_t<decltype(Accessor)>> == ArgCount &&
+  object<std::tuple_element_t<0, boost::callable_traits::args_t<decltype(Accessor)>>>;
+
+
+template<typename T>
+[[nodiscard]]
+bool check_accessor_arg(duk_context* ctx, duk_idx_t idx, ObjectInfo*& objInfo) noexcept
+{
+  if constexpr (object<T>)
+  {
+    objInfo = get_object_info(ctx, idx);
+
+    return type_traits<T>::check_type(ctx, idx, objInfo);
+  }
+  else
+  {
+    return type_traits<T>::check_type(ctx, idx);
+  }
+}
+
+
+template<typename T>
+[[nodiscard]]
+decltype(auto) get_accessor_arg(duk_context* ctx, duk_idx_t idx, ObjectInfo* objInfo)
+{
+  if constexpr (object<T>)
+    return type_traits<T>::get(ctx, idx, objInfo);
+  else
+    return type_traits<T>::get(ctx, idx);
+}
+
+
+template<auto Getter>
+duk_ret_t prop_getter_thunk(duk_context* ctx)
+{
+  using ArgsTuple = boost::callable_traits::args_t<decltype(Getter)>;
+  using Self = std::tuple_element_t<0, ArgsTuple>;
+  using Result = boost::callable_traits::return_type_t<decltype(Getter)>;
+
+  duk_push_this(ctx);
+
+  ObjectInfo* selfInfo = nullptr;
+  if (!check_accessor_arg<Self>(ctx, 0, selfInfo)) [[unlikely]]
+    return DUK_RET_TYPE_ERROR;
+
+  type_traits<Result>::push(ctx, std::invoke(Getter, get_accessor_arg<Self>(ctx, 0, selfInfo)));
+
+  return 1;
+}
+
+
+template<auto Setter>
+duk_ret_t prop_setter_thunk(duk_context* ctx)
+{
+  using ArgsTuple = boost::callable_traits::args_t<decltype(Setter)>;
+  using Self = std::tuple_element_t<0, ArgsTuple>;
+  using Value = std::tuple_element_t<1, ArgsTuple>;
+
+  duk_push_this(ctx);
+
+  ObjectInfo* valueInfo = nullptr;
+  ObjectInfo* selfInfo = nullptr;
+  if (!check_accessor_arg<Value>(ctx, 0, valueInfo) || !check_accessor_arg<Self>(ctx, 1, selfInfo)) [[unlikely]]
+    return DUK_RET_TYPE_ERROR;
+
+  std::invoke(Setter, get_accessor_arg<Self>(ctx, 1, selfInfo), get_accessor_arg<Value>(ctx, 0, valueInfo));
+
+  return 0;
+}
+
+
 } // namespace detail
 
 
@@ -50,14 +132,20 @@ duk_idx_t push_prop_accessor(duk_context* ctx)
 template<auto GetterPtr>
 duk_idx_t push_prop_method_getter(duk_context* ctx)
 {
-  return detail::push_prop_accessor<GetterPtr>(ctx);
+  if constexpr (detail::fixed_arity_accessor<GetterPtr, 1>)
+    return duk_push_c_function(ctx, detail::prop_getter_thunk<GetterPtr>, 0);
+  else
+    return detail::push_prop_accessor<GetterPtr>(ctx);
 }
 
 
 template<auto SetterPtr>
 duk_idx_t push_prop_method_setter(duk_context* ctx)
 {
-  return detail::push_prop_accessor<SetterPtr>(ctx);
+  if constexpr (detail::fixed_arity_accessor<SetterPtr, 2>)
+    return duk_push_c_function(ctx, detail::prop_setter_thunk<SetterPtr>, 1);
+  else
+    return detail::push_prop_accessor<SetterPtr>(ctx);
 }
 
 
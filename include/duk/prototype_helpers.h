@@ -0,0 +1,34 @@
+#ifndef DUKCPP_PROTOTYPE_HELPERS_H
+#define DUKCPP_PROTOTYPE_HELPERS_H
+
+#include <duk/detail/heap_state.h>
+#include <duktape.h>
+
+
+namespace duk
+{
+
+
+// Registers object at idx as the prototype of T. It will be used whenever T is pushed into the same heap without
+// an explicitly specified prototype. Each heap has its own registry, so multiple heaps can have independent bindings
+// of the same types. Registering another prototype for T replaces the previous one.
+template<typename T>
+void register_prototype(duk_context* ctx, duk_idx_t idx)
+{
+  detail::register_prototype(ctx, idx, type_id<T>());
+}
+
+
+// Returns heap pointer to the prototype registered for T, or nullptr if there isn't one.
+template<typename T>
+[[nodiscard]]
+void* get_prototype(duk_context* ctx)
+{
+  return detail::find_prototype(ctx, type_id<T>());
+}
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_PROTOTYPE_HELPERS_H
@@ -1,12 +1,15 @@
 #ifndef DUKCPP_RANGE_H
 #define DUKCPP_RANGE_H
 
+#include <duk/detail/heap_state.h>
+#include <duk/detail/range_cursor.h>
 #include <duk/error.h>
 #include <duk/fwd.h>
 #include <duk/safe_handle.h>
 #include <duk/scoped_pop.h>
 #include <iterator>
 #include <ranges>
+#include <utility>
 #include <variant>
 
 
@@ -14,6 +17,32 @@ namespace duk
 {
 
 
+namespace detail
+{
+
+
+// Checks whether function at iterFuncIdx (Symbol.iterator of an array) is the built-in one of Array.prototype, so array
+// elements can be read by index instead. The built-in function is captured once per heap (see get_heap_state), so
+// replacing global Array doesn't affect the check, while replacing Array.prototype[Symbol.iterator] makes arrays go
+// through the iterator protocol again. Array without Symbol.iterator isn't iterable, unless Duktape doesn't provide
+// the built-in one at all.
+[[nodiscard]]
+inline bool is_array_iterator(duk_context* ctx, duk_idx_t iterFuncIdx)
+{
+  auto& heapState = get_heap_state(ctx);
+
+  if (duk_is_undefined(ctx, iterFuncIdx))
+    return heapState.arrayIndexIteration;
+
+  auto iterFunc = duk_get_heapptr(ctx, iterFuncIdx);
+
+  return iterFunc && iterFunc == heapState.arrayIterator;
+}
+
+
+} // namespace detail
+
+
 template<typename T, handle_type Handle>
 class array_input_range;
 
@@ -232,6 +261,29 @@ public:
     if (end_) [[unlikely]]
       throw error(ctx, "invalid symbol iterator dereference (out of range)");
 
+    if (cursor_)
+    {
+      scoped_pop _(ctx); // RangeCursor::push
+      cursor_->push(ctx);
+
+      // Keep pushed object alive, same as the protocol keeps it referenced by the result object.
+      if (duk_is_object(ctx, -1))
+        currHandle_ = handle(ctx, -1);
+
+      return detail::type_traits<T>::get(ctx, -1);
+    }
+
+    if (arrayIteration_)
+    {
+      scoped_pop _(ctx); // push_handle
+      push_handle(containerHandle_);
+
+      scoped_pop __(ctx); // duk_get_prop_index
+      duk_get_prop_index(ctx, -1, arrayIdx_);
+
+      return detail::type_traits<T>::get(ctx, -1);
+    }
+
     if (currHandle_.empty()) [[unlikely]]
       throw error(ctx, "invalid symbol iterator dereference (uninitialized)");
 
@@ -255,8 +307,10 @@ public:
   [[nodiscard]]
   bool operator==(const symbol_input_iterator& other) const noexcept
   {
-    return (end_ && other.end_ && containerHandle_ == other.containerHandle_) ||
-           iteratorHandle_ == other.iteratorHandle_;
+    if (end_ || other.end_)
+      return end_ && other.end_ && containerHandle_ == other.containerHandle_;
+
+    return this == &other || (!iteratorHandle_.empty() && iteratorHandle_ == other.iteratorHandle_);
   }
 
   [[nodiscard]]
@@ -282,11 +336,49 @@ private:
     getNextValue();
   }
 
+  // Iterates C++ range of an object made iterable by make_iterable.
+  symbol_input_iterator(const Handle& containerHandle, detail::range_cursor_ptr cursor) noexcept :
+    containerHandle_(containerHandle),
+    cursor_(std::move(cursor)),
+    end_(cursor_->done())
+  {
+  }
+
+  // Iterates an array by index.
+  symbol_input_iterator(const Handle& containerHandle, duk_size_t arrayLength) noexcept :
+    containerHandle_(containerHandle),
+    arrayIteration_(true),
+    end_(arrayLength == 0)
+  {
+  }
+
   void getNextValue()
   {
     if (end_) [[unlikely]]
       return;
 
+    if (cursor_)
+    {
+      cursor_->next();
+      end_ = cursor_->done();
+
+      return;
+    }
+
+    if (arrayIteration_)
+    {
+      auto ctx = containerHandle_.ctx();
+
+      scoped_pop _(ctx); // push_handle
+      push_handle(containerHandle_);
+
+      // Length is read on every step, same as the built-in iterator does, so elements added during iteration are
+      // visited too.
+      end_ = ++arrayIdx_ >= duk_get_length(ctx, -1);
+
+      return;
+    }
+
     auto ctx = iteratorHandle_.ctx();
 
     scoped_pop _(ctx); // push_handle
@@ -313,7 +405,10 @@ private:
 
   Handle containerHandle_;
   Handle iteratorHandle_;
-  Handle currHandle_;
+  mutable Handle currHandle_;
+  detail::range_cursor_ptr cursor_;
+  duk_uarridx_t arrayIdx_ = 0;
+  bool arrayIteration_ = false;
   bool end_ = true;
 };
 
@@ -339,10 +434,18 @@ public:
     scoped_pop _(ctx); // push_handle
     push_handle(containerHandle_);
 
-    duk_push_literal(ctx, DUK_WELLKNOWN_SYMBOL("Symbol.iterator"));
+    scoped_pop __(ctx); // duk_get_prop_literal, duk_pcall_method
+    duk_get_prop_literal(ctx, -1, DUK_WELLKNOWN_SYMBOL("Symbol.iterator"));
+
+    // Arrays and C++ ranges wrapped by make_iterable don't need to go through the iterator protocol.
+    if (duk_is_array(ctx, -2) && detail::is_array_iterator(ctx, -1))
+      return { containerHandle_, duk_get_length(ctx, -2) };
+
+    if (auto cursor = detail::make_range_cursor(ctx, -2, -1))
+      return { containerHandle_, detail::range_cursor_ptr(cursor) };
 
-    scoped_pop __(ctx); // duk_pcall_prop
-    duk_pcall_prop(ctx, -2, 0);
+    duk_dup(ctx, -2);
+    duk_pcall_method(ctx, 0);
 
     return { containerHandle_, handle(ctx, -1) };
   }
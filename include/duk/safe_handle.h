@@ -1,10 +1,8 @@
 #ifndef DUKCPP_SAFE_HANDLE_H
 #define DUKCPP_SAFE_HANDLE_H
 
-#include <duk/common.h>
-#include <duk/error.h>
+#include <duk/detail/heap_state.h>
 #include <duk/handle.h>
-#include <duk/scoped_pop.h>
 #include <utility>
 
 
@@ -25,13 +23,15 @@ public:
   }
 
   safe_handle(const safe_handle& other) noexcept :
-    handle_(other.handle_)
+    handle_(other.handle_),
+    heapState_(other.heapState_)
   {
     incRef();
   }
 
   safe_handle(safe_handle&& other) noexcept :
-    handle_(std::move(other.handle_))
+    handle_(std::move(other.handle_)),
+    heapState_(std::exchange(other.heapState_, nullptr))
   {
   }
 
@@ -41,6 +41,7 @@ public:
     {
       decRef();
       handle_ = other.handle_;
+      heapState_ = other.heapState_;
       incRef();
     }
 
@@ -53,6 +54,7 @@ public:
     {
       decRef();
       handle_ = std::move(other.handle_);
+      heapState_ = std::exchange(other.heapState_, nullptr);
     }
 
     return *this;
@@ -100,57 +102,16 @@ public:
   }
 
 private:
-  static constexpr duk_size_t heapPtrSize = sizeof(std::declval<duk::handle>().heap_ptr());
-
-  enum PropertyIndex
-  {
-    INFO_IDX,
-    OBJECT_IDX
-  };
-
-  struct Info final
-  {
-    unsigned long long refCount = 1;
-  };
-
   void incRef() noexcept
   {
     if (handle_.empty())
       return;
 
-    auto ctx = handle_.ctx();
-    auto heapPtr = handle_.heap_ptr();
-
-    scoped_pop _(ctx); // duk_push_global_stash
-    duk_push_global_stash(ctx);
+    // Heap state is looked up once per handle, and then shared by its copies, so copying a handle is only a hash probe.
+    if (!heapState_)
+      heapState_ = &detail::get_heap_state(handle_.ctx());
 
-    scoped_pop __(ctx); // duk_get_prop_heapptr
-    if (!duk_get_prop_lstring(ctx, -1, reinterpret_cast<const char*>(&heapPtr), heapPtrSize))
-    {
-      // undefined on stack
-
-      duk_push_bare_array(ctx);
-
-      push_handle(handle_);
-      if (!duk_put_prop_index(ctx, -2, OBJECT_IDX)) [[unlikely]]
-        duk_fatal(ctx, "handle corrupted (incRef, OBJECT_IDX)");
-
-      duk_push_pointer(ctx, detail::make<Info>(ctx));
-      if (!duk_put_prop_index(ctx, -2, INFO_IDX)) [[unlikely]]
-        duk_fatal(ctx, "handle corrupted (incRef, INFO_IDX)");
-
-      if (!duk_put_prop_lstring(ctx, -3, reinterpret_cast<const char*>(&heapPtr), heapPtrSize)) [[unlikely]]
-        duk_fatal(ctx, "handle corrupted (incRef, put object info)");
-    }
-    else
-    {
-      scoped_pop _(ctx); // duk_get_prop_index
-      if (!duk_get_prop_index(ctx, -1, INFO_IDX)) [[unlikely]]
-        duk_fatal(ctx, "handle corrupted (incRef, get object info)");
-
-      auto info = static_cast<Info*>(duk_get_pointer(ctx, -1));
-      ++info->refCount;
-    }
+    detail::pin(handle_.ctx(), *heapState_, handle_.heap_ptr());
   }
 
   void decRef() noexcept
@@ -158,32 +119,11 @@ private:
     if (handle_.empty())
       return;
 
-    auto ctx = handle_.ctx();
-    auto heapPtr = handle_.heap_ptr();
-
-    scoped_pop _(ctx); // duk_push_global_stash
-    duk_push_global_stash(ctx);
-
-    scoped_pop __(ctx); // duk_get_prop_heapptr
-    if (!duk_get_prop_lstring(ctx, -1, reinterpret_cast<const char*>(&heapPtr), heapPtrSize)) [[unlikely]]
-      duk_fatal(ctx, "handle corrupted (decRef, get object info)");
-
-    scoped_pop ___(ctx); // duk_get_prop_index
-    if (!duk_get_prop_index(ctx, -1, INFO_IDX)) [[unlikely]]
-      duk_fatal(ctx, "handle corrupted (decRef, INFO_IDX)");
-
-    auto info = static_cast<Info*>(duk_get_pointer(ctx, -1));
-
-    if (--info->refCount == 0)
-    {
-      if (!duk_del_prop_lstring(ctx, -3, reinterpret_cast<const char*>(&heapPtr), heapPtrSize)) [[unlikely]]
-        duk_fatal(ctx, "handle corrupted (decRef, del object info)");
-
-      detail::free(ctx, info);
-    }
+    detail::unpin(handle_.ctx(), *heapState_, handle_.heap_ptr());
   }
 
   handle handle_;
+  detail::HeapState* heapState_ = nullptr;
 };
 
 
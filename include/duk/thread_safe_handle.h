@@ -0,0 +1,151 @@
+#ifndef DUKCPP_THREAD_SAFE_HANDLE_H
+#define DUKCPP_THREAD_SAFE_HANDLE_H
+
+#include <duk/detail/heap_state.h>
+#include <duk/handle.h>
+#include <duktape.h>
+#include <utility>
+
+
+namespace duk
+{
+
+
+// Owning handle to a Duktape heap object, which may be copied and destroyed on any thread. It needs to be created on
+// the thread owning the heap.
+//
+// All copies share a single pin, with an atomic reference count. When the last copy is destroyed on another thread,
+// the object is released later on, by the owning thread (see drain_releases). Copies may outlive the heap, in which
+// case destroying them only frees the pin. Other uses of such copies are undefined behavior.
+class thread_safe_handle final
+{
+public:
+  thread_safe_handle() noexcept = default;
+
+  thread_safe_handle(const handle& handle) noexcept :
+    handle_(handle)
+  {
+    if (!handle_.empty())
+      sharedPin_ = detail::make_shared_pin(handle_.ctx(), handle_.heap_ptr());
+  }
+
+  thread_safe_handle(const thread_safe_handle& other) noexcept :
+    handle_(other.handle_),
+    sharedPin_(other.sharedPin_)
+  {
+    incRef();
+  }
+
+  thread_safe_handle(thread_safe_handle&& other) noexcept :
+    handle_(std::move(other.handle_)),
+    sharedPin_(std::exchange(other.sharedPin_, nullptr))
+  {
+  }
+
+  thread_safe_handle& operator=(const thread_safe_handle& other) noexcept
+  {
+    if (&other != this)
+    {
+      decRef();
+      handle_ = other.handle_;
+      sharedPin_ = other.sharedPin_;
+      incRef();
+    }
+
+    return *this;
+  }
+
+  thread_safe_handle& operator=(thread_safe_handle&& other) noexcept
+  {
+    if (&other != this)
+    {
+      decRef();
+      handle_ = std::move(other.handle_);
+      sharedPin_ = std::exchange(other.sharedPin_, nullptr);
+    }
+
+    return *this;
+  }
+
+  ~thread_safe_handle() noexcept
+  {
+    decRef();
+  }
+
+  [[nodiscard]]
+  bool operator==(const thread_safe_handle& other) const noexcept
+  {
+    return handle_ == other.handle_;
+  }
+
+  [[nodiscard]]
+  bool operator!=(const thread_safe_handle& other) const noexcept
+  {
+    return !operator==(other);
+  }
+
+  [[nodiscard]]
+  const handle& get() const noexcept
+  {
+    return handle_;
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept
+  {
+    return handle_.empty();
+  }
+
+  [[nodiscard]]
+  duk_context* ctx() const noexcept
+  {
+    return handle_.ctx();
+  }
+
+  [[nodiscard]]
+  void* heap_ptr() const noexcept
+  {
+    return handle_.heap_ptr();
+  }
+
+private:
+  friend void drain_releases(const thread_safe_handle& handle) noexcept;
+
+  void incRef() noexcept
+  {
+    if (sharedPin_)
+      sharedPin_->refCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void decRef() noexcept
+  {
+    if (sharedPin_)
+      detail::release_shared_pin(handle_.ctx(), sharedPin_);
+  }
+
+  handle handle_;
+  detail::SharedPin* sharedPin_ = nullptr;
+};
+
+
+// Releases objects whose last thread_safe_handle was destroyed on another thread. Needs to be called on the thread
+// owning the heap, at points where releasing objects (and running their finalizers) is safe.
+inline void drain_releases(duk_context* ctx) noexcept
+{
+  if (auto heapState = detail::find_heap_state(ctx))
+    detail::drain_releases(ctx, *heapState);
+}
+
+
+// Same as above, but doesn't need to look heap state up.
+inline void drain_releases(const thread_safe_handle& handle) noexcept
+{
+  if (handle.sharedPin_ && !handle.sharedPin_->heapLink->heapDestroyed.load())
+    detail::drain_releases(handle.ctx(), *handle.sharedPin_->heapState);
+}
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_THREAD_SAFE_HANDLE_H
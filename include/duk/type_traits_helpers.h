@@ -67,6 +67,21 @@ inline static bool clone(duk_context* ctx, duk_idx_t idx)
 }
 
 
+// Copies mirrored properties (see class_traits_mirror) of object at idx back to its C++ object. Returns false if value
+// at idx isn't an object created by dukcpp.
+inline static bool sync(duk_context* ctx, duk_idx_t idx)
+{
+  return detail::sync_object(ctx, idx);
+}
+
+
+// Updates mirrored properties of object at idx from its C++ object (e.g. after C++ code modified it).
+inline static bool refresh(duk_context* ctx, duk_idx_t idx)
+{
+  return detail::refresh_object(ctx, idx);
+}
+
+
 } // namespace duk
 
 
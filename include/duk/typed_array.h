@@ -0,0 +1,62 @@
+#ifndef DUKCPP_TYPED_ARRAY_H
+#define DUKCPP_TYPED_ARRAY_H
+
+#include <duk/detail/typed_array.h>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+
+namespace duk
+{
+
+
+template<typename Container>
+concept typed_array_container = std::ranges::contiguous_range<Container> && std::ranges::sized_range<Container> &&
+  detail::typed_array_element<std::ranges::range_value_t<Container>>;
+
+
+// Contiguous container of arithmetic values, pushed to ES as a typed array viewing container's own storage.
+//
+// Container is moved into the heap when pushed, and destroyed once the typed array (and its ArrayBuffer) is finalized,
+// so the storage lives exactly as long as ES can see it. Pushing std::span instead copies the values.
+//
+// return duk::typed_array(decoder.samples()); // Float32Array for std::vector<float>
+template<typed_array_container Container>
+class typed_array final
+{
+public:
+  using value_type = std::ranges::range_value_t<Container>;
+
+  explicit typed_array(Container container) noexcept(std::is_nothrow_move_constructible_v<Container>) :
+    container_(std::move(container))
+  {
+  }
+
+  [[nodiscard]]
+  Container& get() noexcept
+  {
+    return container_;
+  }
+
+  [[nodiscard]]
+  const Container& get() const noexcept
+  {
+    return container_;
+  }
+
+  [[nodiscard]]
+  Container release() noexcept(std::is_nothrow_move_constructible_v<Container>)
+  {
+    return std::move(container_);
+  }
+
+private:
+  Container container_;
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_TYPED_ARRAY_H
@@ -0,0 +1,237 @@
+#ifndef DUKCPP_WEAK_HANDLE_H
+#define DUKCPP_WEAK_HANDLE_H
+
+#include <duk/detail/heap_state.h>
+#include <duk/detail/type_traits.h>
+#include <duk/error.h>
+#include <duk/handle.h>
+#include <duk/safe_handle.h>
+#include <duk/scoped_pop.h>
+#include <duktape.h>
+#include <cstddef>
+#include <string_view>
+
+
+namespace duk
+{
+
+
+namespace detail
+{
+
+
+// Returns true if finalizer is one of the finalizers installed by dukcpp, all of which expire weak slots.
+[[nodiscard]]
+inline bool is_dukcpp_finalizer(duk_context* ctx, void* finalizer)
+{
+  static constexpr std::string_view names[] = {
+    object_finalizer_name,
+    function_finalizer_name,
+    buffer_finalizer_name,
+    range_iterator_finalizer_name,
+    weak_finalizer_name
+  };
+
+  scoped_pop _(ctx); // duk_push_heap_stash
+  duk_push_heap_stash(ctx);
+
+  // Finalizers which haven't been created yet can't be installed anywhere, so they're not created here.
+  for (auto name : names)
+  {
+    scoped_pop __(ctx); // get_prop_string
+    if (get_prop_string(ctx, -1, name) && duk_get_heapptr(ctx, -1) == finalizer)
+      return true;
+  }
+
+  return false;
+}
+
+
+// Sets finalizer at the top of the stack (and pops it) as finalizer of object at idx. Unlike duk_set_finalizer, it
+// returns false instead of throwing if the object isn't extensible.
+[[nodiscard]]
+inline bool try_set_finalizer(duk_context* ctx, duk_idx_t idx)
+{
+  static constexpr auto run = [](duk_context* ctx, [[maybe_unused]] void* udata) -> duk_ret_t
+  {
+    duk_set_finalizer(ctx, 0);
+
+    return 0;
+  };
+
+  duk_dup(ctx, idx);
+  duk_insert(ctx, -2);
+
+  scoped_pop _(ctx); // duk_safe_call
+  return duk_safe_call(ctx, run, nullptr, 2, 1) == DUK_EXEC_SUCCESS;
+}
+
+
+// Returns weak slot of object at idx, allocating it if the object doesn't have one yet. Slots are found by heap
+// pointer, so the object doesn't store it, but it needs to be finalized by a function expiring its slot:
+// - objects with a finalizer installed by dukcpp already are, unless it's inherited, since it would be lost if script
+//   code replaced their prototype, so it gets installed on the object too,
+// - objects with any other finalizer get weak_finalizer instead, which calls the replaced finalizer in turn,
+// - objects without a finalizer get weak_finalizer.
+// Objects which already have a dukcpp finalizer of their own are left as they are. Others can't get a finalizer if they
+// aren't extensible (e.g. frozen), in which case error is thrown.
+[[nodiscard]]
+inline std::size_t get_weak_slot(duk_context* ctx, duk_idx_t idx, HeapState& heapState)
+{
+  idx = duk_normalize_index(ctx, idx);
+
+  auto heapPtr = duk_get_heapptr(ctx, idx);
+
+  if (auto slot = find_weak_slot(heapState, heapPtr); slot != HeapState::noWeakSlot)
+    return slot;
+
+  scoped_pop _(ctx); // duk_get_finalizer
+  duk_get_finalizer(ctx, idx);
+  auto currentFinalizer = duk_get_heapptr(ctx, -1);
+
+  // Duktape doesn't tell own finalizer from an inherited one, so the finalizer is own if the prototype has another.
+  void* inheritedFinalizer = nullptr;
+
+  duk_get_prototype(ctx, idx);
+  if (duk_is_object(ctx, -1))
+  {
+    duk_get_finalizer(ctx, -1);
+    inheritedFinalizer = duk_get_heapptr(ctx, -1);
+    duk_pop(ctx);
+  }
+  duk_pop(ctx); // Pop prototype
+
+  auto dukcppFinalizer = currentFinalizer && is_dukcpp_finalizer(ctx, currentFinalizer);
+
+  auto slot = acquire_weak_slot(ctx, heapState, heapPtr);
+
+  if (dukcppFinalizer && currentFinalizer != inheritedFinalizer)
+    return slot;
+
+  auto chainedFinalizer = currentFinalizer && !dukcppFinalizer;
+
+  // Replaced finalizer is kept reachable by the weak finalizer array, until weak_finalizer takes it.
+  const auto putChainedFinalizer = [ctx, slot](duk_idx_t finalizerIdx)
+  {
+    finalizerIdx = duk_normalize_index(ctx, finalizerIdx);
+
+    duk_push_heap_stash(ctx);
+    duk_get_prop_literal(ctx, -1, DUKCPP_DETAIL_INTERNAL_NAME("weakFinalizers"));
+    duk_dup(ctx, finalizerIdx);
+    duk_put_prop_index(ctx, -2, static_cast<duk_uarridx_t>(slot));
+    duk_pop_2(ctx); // Pop weak finalizer array and heap stash
+  };
+
+  if (chainedFinalizer)
+  {
+    putChainedFinalizer(-1);
+
+    // Entry may have moved, if finalizers run by the allocations above released other slots.
+    find_heap_ptr_entry(heapState.weakEntries, heapState.weakEntryCapacity, heapPtr)->chainedFinalizer = true;
+  }
+
+  if (dukcppFinalizer)
+    duk_dup_top(ctx);
+  else
+    push_shared_finalizer(ctx, weak_finalizer_name, weak_finalizer);
+
+  if (!try_set_finalizer(ctx, idx)) [[unlikely]]
+  {
+    if (chainedFinalizer)
+    {
+      duk_push_undefined(ctx);
+      putChainedFinalizer(-1);
+      duk_pop(ctx);
+    }
+
+    release_weak_slot(heapState, find_heap_ptr_entry(heapState.weakEntries, heapState.weakEntryCapacity, heapPtr));
+
+    throw error(ctx, "weak handle target isn't extensible");
+  }
+
+  return slot;
+}
+
+
+} // namespace detail
+
+
+// Non-owning handle to a Duktape object, which knows whether the object is still alive.
+//
+// Object gets a weak slot in a per-heap table, with a generation number bumped when the object is finalized, so
+// checking for liveness is a single comparison. Objects resurrected by finalizers stay expired.
+//
+// Slots are found by heap pointer, so the object isn't changed, except for getting a finalizer if it doesn't have one
+// managed by dukcpp (see detail::get_weak_slot). A finalizer installed by script code keeps being called.
+class weak_handle final
+{
+public:
+  weak_handle() noexcept = default;
+
+  // Throws if pointed value isn't an object, or if it needs a finalizer, but isn't extensible (e.g. a frozen object which
+  // doesn't have a finalizer managed by dukcpp).
+  weak_handle(const handle& handle) :
+    handle_(handle)
+  {
+    if (handle_.empty())
+      return;
+
+    auto ctx = handle_.ctx();
+
+    scoped_pop _(ctx); // push_handle
+    push_handle(handle_);
+
+    if (!duk_is_object(ctx, -1)) [[unlikely]]
+      throw error(ctx, "weak handle needs to point to an object");
+
+    auto& heapState = detail::get_heap_state(ctx);
+
+    slot_ = detail::get_weak_slot(ctx, -1, heapState);
+    generation_ = heapState.weakSlots[slot_].generation;
+    heapState_ = &heapState;
+  }
+
+  [[nodiscard]]
+  bool operator==(const weak_handle& other) const noexcept = default;
+
+  [[nodiscard]]
+  bool expired() const noexcept
+  {
+    return !heapState_ || heapState_->weakSlots[slot_].generation != generation_;
+  }
+
+  // Returns owning handle to the object, or an empty one if the object has been finalized.
+  [[nodiscard]]
+  safe_handle lock() const noexcept
+  {
+    if (expired())
+      return {};
+
+    return safe_handle(handle_);
+  }
+
+  [[nodiscard]]
+  duk_context* ctx() const noexcept
+  {
+    return handle_.ctx();
+  }
+
+  // Pointer may dangle once the handle has expired.
+  [[nodiscard]]
+  void* heap_ptr() const noexcept
+  {
+    return handle_.heap_ptr();
+  }
+
+private:
+  handle handle_;
+  detail::HeapState* heapState_ = nullptr;
+  std::size_t slot_ = 0;
+  std::size_t generation_ = 0;
+};
+
+
+} // namespace duk
+
+
+#endif // DUKCPP_WEAK_HANDLE_H
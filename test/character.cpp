@@ -19,6 +19,8 @@ void* registerCharacter(duk_context* ctx, duk_idx_t idx)
 
   auto prototypeHandle = duk_get_heapptr(ctx, -1);
 
+  duk::register_prototype<Character>(ctx, -1);
+
   duk::def_prop<&Character::id>(ctx, -1, "id");
   duk::def_prop<&Character::name>(ctx, -1, "name");
   duk::def_prop<&Character::type>(ctx, -1, "type");
@@ -33,7 +35,5 @@ void* registerCharacter(duk_context* ctx, duk_idx_t idx)
 
   duk_put_prop_string(ctx, idx - 1, "Character");
 
-  duk::class_traits_prototype<Character>::heap_ptr = prototypeHandle;
-
   return prototypeHandle;
 }
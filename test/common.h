@@ -52,19 +52,6 @@ struct iterable_traits_type<std::list<T>>
 };
 
 
-template<typename T>
-struct class_traits_prototype
-{
-  [[nodiscard]]
-  static void* get(duk_context*) noexcept
-  {
-    return heap_ptr;
-  }
-
-  inline static void* heap_ptr = nullptr;
-};
-
-
 } // namespace duk
 
 
@@ -0,0 +1,29 @@
+#ifndef DUKCPP_TEST_CONFIG_H
+#define DUKCPP_TEST_CONFIG_H
+
+#include <duk/class.h>
+#include <string>
+
+
+// Config
+
+struct Config
+{
+  int limit = 0;
+  std::string name;
+  bool enabled = false;
+};
+
+
+template<>
+struct duk::class_traits_mirror<Config>
+{
+  using type = duk::mirror<
+    duk::mirrored<"limit", &Config::limit>,
+    duk::mirrored<"name", &Config::name>,
+    duk::mirrored<"enabled", &Config::enabled>
+  >;
+};
+
+
+#endif // DUKCPP_TEST_CONFIG_H
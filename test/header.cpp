@@ -0,0 +1,2 @@
+// Makes sure the umbrella header compiles on its own, without any other header included first.
+#include <duk/duk.h>
@@ -10,15 +10,13 @@ void registerInhBase(duk_context* ctx, duk_idx_t idx)
 
   duk_push_object(ctx); // prototype
 
-  auto prototypeHandle = duk_get_heapptr(ctx, -1);
+  duk::register_prototype<InhBase>(ctx, -1);
 
   duk::put_prop_function<&InhBase::methodA>(ctx, -1, "methodA");
 
   duk_put_prop_string(ctx, -2, "prototype");
 
   duk_put_prop_string(ctx, idx - 1, "InhBase");
-
-  duk::class_traits_prototype<InhBase>::heap_ptr = prototypeHandle;
 }
 
 
@@ -30,18 +28,16 @@ void registerInhDer(duk_context* ctx, duk_idx_t idx)
 
   duk_push_object(ctx);
 
-  auto prototypeHandle = duk_get_heapptr(ctx, -1);
+  duk::register_prototype<InhDer>(ctx, -1);
 
   duk::put_prop_function<&InhDer::methodB>(ctx, -1, "methodB");
 
-  duk_push_heapptr(ctx, duk::class_traits_prototype<InhBase>::heap_ptr);
+  duk_push_heapptr(ctx, duk::get_prototype<InhBase>(ctx));
   duk_set_prototype(ctx, -2);
 
   duk_put_prop_string(ctx, -2, "prototype");
 
   duk_put_prop_string(ctx, idx - 1, "InhDer");
-
-  duk::class_traits_prototype<InhDer>::heap_ptr = prototypeHandle;
 }
 
 
@@ -53,16 +49,35 @@ void registerInhFinal(duk_context* ctx, duk_idx_t idx)
 
   duk_push_object(ctx);
 
-  auto prototypeHandle = duk_get_heapptr(ctx, -1);
+  duk::register_prototype<InhFinal>(ctx, -1);
 
   duk::put_prop_function<&InhFinal::methodC>(ctx, -1, "methodC");
 
-  duk_push_heapptr(ctx, duk::class_traits_prototype<InhDer>::heap_ptr);
+  duk_push_heapptr(ctx, duk::get_prototype<InhDer>(ctx));
   duk_set_prototype(ctx, -2);
 
   duk_put_prop_string(ctx, -2, "prototype");
 
   duk_put_prop_string(ctx, idx - 1, "InhFinal");
+}
 
-  duk::class_traits_prototype<InhFinal>::heap_ptr = prototypeHandle;
+
+void registerInhClasses(duk_context* ctx, duk_idx_t idx)
+{
+  duk::class_<InhBase,
+    duk::constructor<duk::ctor<InhBase>>,
+    duk::method<"methodA", &InhBase::methodA>
+  >::put_prop(ctx, idx, "InhBase");
+
+  duk::class_<InhDer,
+    duk::constructor<duk::ctor<InhDer>>,
+    duk::base<InhBase>,
+    duk::method<"methodB", &InhDer::methodB>
+  >::put_prop(ctx, idx, "InhDer");
+
+  duk::class_<InhFinal,
+    duk::constructor<duk::ctor<InhFinal>>,
+    duk::base<InhDer>,
+    duk::method<"methodC", &InhFinal::methodC>
+  >::put_prop(ctx, idx, "InhFinal");
 }
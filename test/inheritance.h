@@ -58,5 +58,8 @@ void registerInhBase(duk_context* ctx, duk_idx_t idx);
 void registerInhDer(duk_context* ctx, duk_idx_t idx);
 void registerInhFinal(duk_context* ctx, duk_idx_t idx);
 
+// Same bindings as the three above (registered in that order), declared with duk::class_
+void registerInhClasses(duk_context* ctx, duk_idx_t idx);
+
 
 #endif // DUKCPP_TEST_INHERITANCE_H
@@ -2,6 +2,8 @@
 #define DUKCPP_TEST_LIFETIME_H
 
 #include <duk/callable.h>
+#include <duk/class.h>
+#include <type_traits>
 
 
 // Lifetime
@@ -88,6 +90,14 @@ struct CallableLifetime : public Lifetime
 };
 
 
+// InlineLifetime
+
+struct InlineLifetime : public Lifetime
+{
+  using Lifetime::Lifetime;
+};
+
+
 namespace duk
 {
 
@@ -97,6 +107,12 @@ struct callable_traits_type<CallableLifetime>
   using type = CallableLifetime;
 };
 
+
+template<>
+struct class_traits_inline_storage<InlineLifetime> : std::true_type
+{
+};
+
 } // namespace duk
 
 
@@ -1,5 +1,6 @@
 #include "character.h"
 #include "common.h"
+#include "config.h"
 #include "functor.h"
 #include "inheritance.h"
 #include "lifetime.h"
@@ -11,8 +12,11 @@
 #include <algorithm>
 #include <cstring>
 #include <numeric>
+#include <ranges>
 #include <stdexcept>
+#include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -35,6 +39,7 @@ static_assert(!std::is_copy_assignable_v<duk::input_iterator<int>>);
 
 static_assert(duk::handle_type<duk::handle>);
 static_assert(duk::handle_type<duk::safe_handle>);
+static_assert(duk::handle_type<duk::thread_safe_handle>);
 
 
 // Check if strings match duk::string_type concept.
@@ -398,17 +403,22 @@ TEST_CASE_METHOD(DukCppTest, "Register functor (without duk::callable_traits_typ
 }
 
 
-TEST_CASE_METHOD(DukCppTest, "Check object copy counts")
+TEMPLATE_TEST_CASE_METHOD(DukCppTemplateTest, "Check object copy counts", "",
+  Lifetime,
+  InlineLifetime
+)
 {
+  auto& ctx = DukCppTest::ctx_;
+
   Lifetime::Observer observer;
 
-  duk_push_global_object(ctx_);
+  duk_push_global_object(ctx);
 
-  duk::put_prop(ctx_, -1, "func", Lifetime{observer});
+  duk::put_prop(ctx, -1, "func", TestType{observer});
 
-  duk_pop(ctx_); // duk_push_global_object
+  duk_pop(ctx); // duk_push_global_object
 
-  ctx_.release();
+  ctx.release();
 
   REQUIRE(observer.countersWithinLimits({
     .ctorCount = 1,
@@ -423,6 +433,43 @@ TEST_CASE_METHOD(DukCppTest, "Check object copy counts")
 }
 
 
+TEST_CASE_METHOD(DukCppTest, "Register light function")
+{
+  static constexpr auto multiply = [](int a, int b) { return a * b; };
+  static constexpr auto negate = [](int a) { return -a; };
+
+  duk_push_global_object(ctx_);
+
+  duk::put_prop_light_function<multiply, negate>(ctx_, -1, "f");
+
+  auto prototypeHandle = registerVector(ctx_, -1);
+
+  duk_push_heapptr(ctx_, prototypeHandle);
+  duk::put_prop_light_method<&Vector::length>(ctx_, -1, "lightLength");
+  duk_pop(ctx_); // Pop prototype
+
+  duk_pop(ctx_); // Pop global object
+
+  duk_get_global_string(ctx_, "f");
+  REQUIRE(duk_is_lightfunc(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "f(5, 10)");
+  REQUIRE(duk::get<int>(ctx_, -1) == 50);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "f(5)");
+  REQUIRE(duk::get<int>(ctx_, -1) == -5);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "new Vector(3, 4).lightLength()");
+  REQUIRE(equals(duk::get<float>(ctx_, -1), 5.0f, 1e-5f));
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "f('s')") != 0); // Call failed with an error.
+}
+
+
 TEST_CASE_METHOD(DukCppTest, "Register lambda with capture list")
 {
   auto multiply = [a = 5](int b) -> int
@@ -439,6 +486,92 @@ TEST_CASE_METHOD(DukCppTest, "Register lambda with capture list")
 }
 
 
+TEST_CASE_METHOD(DukCppTest, "Register lambda without capture list")
+{
+  auto multiply = [](int a, int b) -> int
+  {
+    return a * b;
+  };
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function(ctx_, -1, "multiply", multiply);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "multiply(5, 10)");
+  REQUIRE(duk::get<int>(ctx_, -1) == 50);
+  duk_pop(ctx_);
+
+  // Stateless functors aren't stored, so there is nothing to finalize.
+  duk_get_global_string(ctx_, "multiply");
+  duk_get_finalizer(ctx_, -1);
+  REQUIRE(duk_is_undefined(ctx_, -1));
+  duk_pop(ctx_);
+
+  REQUIRE(duk::finalize(ctx_, -1) == false);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Stateful lambda slots")
+{
+  int factor = 2;
+
+  auto scale = [&factor](int a) -> int
+  {
+    return a * factor;
+  };
+
+  auto offset = [&factor](int a) -> int
+  {
+    return a + factor;
+  };
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function(ctx_, -1, "scale", scale);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "scale(5)");
+  REQUIRE(duk::get<int>(ctx_, -1) == 10);
+  duk_pop(ctx_);
+
+  // Finalized function releases its slot, and mustn't reach functor that reuses it.
+  duk_get_global_string(ctx_, "scale");
+  REQUIRE(duk_get_magic(ctx_, -1) != 0);
+  REQUIRE(duk::finalize(ctx_, -1));
+  REQUIRE(duk_get_magic(ctx_, -1) == 0);
+  duk_pop(ctx_);
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function(ctx_, -1, "offset", offset);
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "scale(5)") != 0); // Call failed with an error.
+  duk_pop(ctx_);
+
+  factor = 3;
+
+  duk_peval_string(ctx_, "offset(5)");
+  REQUIRE(duk::get<int>(ctx_, -1) == 8);
+  duk_pop(ctx_);
+
+  // Each heap has slots of its own.
+  duk::context ctx2(duk_create_heap(Allocator::alloc, Allocator::realloc, Allocator::free, &allocator_, errorHandler));
+
+  duk_get_global_string(ctx_, "offset");
+  auto magic = duk_get_magic(ctx_, -1);
+  duk_pop(ctx_);
+
+  duk_push_global_object(ctx2);
+  duk::put_prop_function(ctx2, -1, "scale", scale);
+  duk_get_prop_string(ctx2, -1, "scale");
+  REQUIRE(duk_get_magic(ctx2, -1) == magic);
+  duk_pop_2(ctx2);
+
+  duk_peval_string(ctx2, "scale(5)");
+  REQUIRE(duk::get<int>(ctx2, -1) == 15);
+  duk_pop(ctx2);
+}
+
+
 TEST_CASE_METHOD(DukCppTest, "Call ES function in C++ (non-null return value)")
 {
   duk_peval_string(ctx_, "function f(a, b) { return a * b; }; (f);");
@@ -456,6 +589,161 @@ TEST_CASE_METHOD(DukCppTest, "Call ES function in C++ (null return value)")
 }
 
 
+TEST_CASE_METHOD(DukCppTest, "Prepared call")
+{
+  duk_peval_string(ctx_, "(function (a, b) { return a + b; })");
+
+  auto add = duk::prepared_call<int(int, int)>(duk::handle(ctx_, -1));
+  auto concat = duk::prepared_call<std::string(const std::string&, int), { .check_result = false }>(
+    duk::handle(ctx_, -1)
+  );
+
+  duk_pop(ctx_);
+
+  auto top = duk_get_top(ctx_);
+
+  REQUIRE(add(2, 3) == 5);
+  REQUIRE(concat("a", 1) == "a1");
+  REQUIRE(duk_get_top(ctx_) == top);
+
+  // Result type mismatch is detected in checked mode.
+  duk_peval_string(ctx_, "(function () { return 'a'; })");
+  auto wrongResult = duk::prepared_call<int()>(duk::handle(ctx_, -1));
+  duk_pop(ctx_);
+
+  REQUIRE_THROWS_AS(wrongResult(), duk::error);
+
+  duk_peval_string(ctx_, "(function () { throw new Error('failed'); })");
+  auto throwing = duk::prepared_call<void()>(duk::handle(ctx_, -1));
+  duk_pop(ctx_);
+
+  REQUIRE_THROWS_AS(throwing(), duk::es_error);
+  REQUIRE(duk_get_top(ctx_) == top);
+
+  duk_push_int(ctx_, 1);
+  REQUIRE_THROWS_AS(duk::prepared_call<void()>(duk::handle(ctx_, -1)), duk::error);
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Batched calls")
+{
+  std::vector<int> input(100);
+  std::iota(input.begin(), input.end(), 0);
+
+  duk_peval_string(ctx_, "var sum = 0; (function (x) { sum += x; return x < 50 ? x * 2 : 'big'; })");
+  auto f = duk::safe_function_handle<int>(duk::handle(ctx_, -1));
+  duk_pop(ctx_);
+
+  auto top = duk_get_top(ctx_);
+
+  duk::for_each_call(f, input);
+
+  duk_peval_string(ctx_, "sum");
+  REQUIRE(duk::get<int>(ctx_, -1) == 4950);
+  duk_pop(ctx_);
+
+  std::vector<int> output(50);
+  auto end = duk::map_call(f, std::views::take(input, 50), output.begin());
+  REQUIRE(end == output.end());
+  REQUIRE(output[49] == 98);
+
+  // Result of unexpected type ends the batch. Results written so far stay in the output.
+  std::vector<int> partial;
+  REQUIRE_THROWS_AS(duk::map_call(f, input, std::back_inserter(partial)), duk::es_error);
+  REQUIRE(partial.size() == 50);
+
+  duk_peval_string(ctx_, "(function (x) { if (x == 3) throw new Error('failed'); return x; })");
+  auto g = duk::safe_function_handle<int>(duk::handle(ctx_, -1));
+  duk_pop(ctx_);
+
+  partial.clear();
+  std::size_t completed = 0;
+  REQUIRE_THROWS_AS(duk::map_call(g, input, std::back_inserter(partial), &completed), duk::es_error);
+  REQUIRE(partial.size() == 3);
+  REQUIRE(completed == 3);
+
+  // C++ exceptions keep their type.
+  struct Full : std::exception
+  {
+  };
+
+  struct LimitedOutput
+  {
+    using difference_type = std::ptrdiff_t;
+
+    LimitedOutput& operator*() { return *this; }
+    LimitedOutput& operator++() { return *this; }
+    LimitedOutput& operator++(int) { return *this; }
+
+    LimitedOutput& operator=(int value)
+    {
+      if (values->size() == 5)
+        throw Full{};
+
+      values->push_back(value);
+
+      return *this;
+    }
+
+    std::vector<int>* values;
+  };
+
+  partial.clear();
+  REQUIRE_THROWS_AS(duk::map_call(f, input, LimitedOutput{ &partial }, &completed), Full);
+  REQUIRE(partial.size() == 5);
+  REQUIRE(completed == 5);
+
+  REQUIRE(duk_get_top(ctx_) == top);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Method handle")
+{
+  duk_peval_string(ctx_, R"__(
+    ({
+      total: 0,
+      onTick: function (dt, scale) { this.total += dt * scale; return this.total; }
+    })
+  )__");
+  auto plugin = duk::safe_handle(duk::handle(ctx_, -1));
+  duk_pop(ctx_);
+
+  auto onTick = duk::method_handle<int>(ctx_, "onTick");
+  auto onEvent = duk::method_handle<void>(ctx_, "onEvent");
+
+  auto top = duk_get_top(ctx_);
+
+  REQUIRE(onTick(plugin, 1, 2) == 2);
+  REQUIRE(onTick(plugin, 3, 2) == 8);
+
+  // Missing method.
+  REQUIRE_THROWS_AS(onEvent(plugin), duk::es_error);
+
+  REQUIRE(duk_get_top(ctx_) == top);
+
+  // Object handle of another thread of the same heap is called on that thread.
+  duk_push_thread(ctx_);
+  auto thread = duk_get_context(ctx_, -1);
+
+  duk_push_heapptr(thread, plugin.heap_ptr());
+  auto threadPlugin = duk::handle(thread, -1);
+  auto threadTop = duk_get_top(thread);
+
+  REQUIRE(onTick(threadPlugin, 1, 2) == 10);
+  REQUIRE(duk_get_top(thread) == threadTop);
+  REQUIRE(duk_get_top(ctx_) == top + 1);
+
+  duk_pop(ctx_); // Pop thread
+
+  // Objects of another heap are rejected.
+  duk::context ctx2(duk_create_heap(Allocator::alloc, Allocator::realloc, Allocator::free, &allocator_, errorHandler));
+  duk_push_object(ctx2);
+  REQUIRE_THROWS_AS(onTick(duk::handle(ctx2, -1), 1, 2), duk::error);
+  duk_pop(ctx2);
+}
+
+
 TEST_CASE_METHOD(DukCppTest, "Register function (function argument)")
 {
   auto multiply = [](int a, std::function<int()> f) -> int
@@ -583,116 +871,524 @@ TEST_CASE_METHOD(DukCppTest, "safe_handle")
 }
 
 
-TEST_CASE_METHOD(DukCppTest, "Allocator")
+TEST_CASE_METHOD(DukCppTest, "safe_handle (many objects)")
 {
-  using string = std::basic_string<char, std::char_traits<char>, duk::allocator<char>>;
+  static int finalizedCount;
+  finalizedCount = 0;
 
-  auto s1 = string{"s1", duk::allocator<char>(ctx_)};
-  auto s2 = string{"s2", duk::allocator<char>(ctx_)};
+  static constexpr auto finalizer = [](duk_context*) -> duk_ret_t
+  {
+    ++finalizedCount;
 
-  REQUIRE(s1 + s2 == "s1s2");
-}
+    return 0;
+  };
 
+  const auto makeObject = [&](int id)
+  {
+    duk::scoped_pop _(ctx_); // duk_push_object
+    duk_push_object(ctx_);
 
-TEST_CASE_METHOD(DukCppTest, "Safe handle (function)")
-{
-  duk_peval_string(ctx_, "function f() { return 123; }; (f);");
+    duk_push_int(ctx_, id);
+    duk_put_prop_index(ctx_, -2, 0);
 
-  auto funcHandle = duk::safe_handle(duk::handle(ctx_, -1));
+    duk_push_c_function(ctx_, finalizer, 1);
+    duk_set_finalizer(ctx_, -2);
 
-  duk_pop(ctx_); // Pop function.
+    return duk::safe_handle(duk::handle(ctx_, -1));
+  };
 
-  // Make sure function is available for reclamation by gc.
-  // https://duktape.org/guide#limitations.12
-  duk_peval_string(ctx_, "f.prototype = null; f = null;");
+  const auto checkObjectIds = [&](const std::vector<duk::safe_handle>& handles, int step)
+  {
+    for (std::size_t i = 0; i < handles.size(); ++i)
+    {
+      duk::scoped_pop _(ctx_, 2); // push_handle, duk_get_prop_index
+      push_handle(handles[i]);
+      duk_get_prop_index(ctx_, -1, 0);
+
+      if (duk_get_int(ctx_, -1) != static_cast<int>(i) * step)
+        return false;
+    }
+
+    return true;
+  };
+
+  static constexpr int count = 1000;
+
+  std::vector<duk::safe_handle> handles;
+  for (int i = 0; i < count; ++i)
+    handles.push_back(makeObject(i));
+
+  auto copies = handles;
 
   duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == 0);
+  REQUIRE(checkObjectIds(handles, 1));
 
-  auto func = duk::safe_function_handle<int>(funcHandle);
+  // Copies keep objects alive.
+  handles.clear();
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == 0);
+  REQUIRE(checkObjectIds(copies, 1));
 
-  REQUIRE(func() == 123);
-}
+  // Release every other object, which removes entries from the middle of probe sequences.
+  std::vector<duk::safe_handle> evenCopies;
+  for (int i = 0; i < count; i += 2)
+    evenCopies.push_back(copies[i]);
 
+  copies.clear();
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == count / 2);
+  REQUIRE(checkObjectIds(evenCopies, 2));
 
-TEST_CASE_METHOD(DukCppTest, "Push and get std::string")
-{
-  duk::push(ctx_, std::string("test string"));
-  REQUIRE(duk::get<std::string>(ctx_, -1) == "test string");
-}
+  // Released reference slots get reused.
+  for (int i = 0; i < count / 2; ++i)
+    handles.push_back(makeObject(i));
 
+  duk_gc(ctx_, 0);
+  REQUIRE(checkObjectIds(handles, 1));
+  REQUIRE(checkObjectIds(evenCopies, 2));
 
-TEST_CASE_METHOD(DukCppTest, "Push and get std::string_view")
-{
-  duk::push(ctx_, std::string_view("test string"));
-  REQUIRE(duk::get<std::string_view>(ctx_, -1) == "test string");
+  handles.clear();
+  evenCopies.clear();
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == count + count / 2);
 }
 
 
-TEST_CASE_METHOD(DukCppTest, "Push and get const char*")
+TEST_CASE_METHOD(DukCppTest, "thread_safe_handle")
 {
-  duk::push(ctx_, "test string");
-  REQUIRE(std::strcmp(duk::get<const char*>(ctx_, -1), "test string") == 0);
-}
+  static int finalizedCount;
+  finalizedCount = 0;
 
+  static constexpr auto finalizer = [](duk_context*) -> duk_ret_t
+  {
+    ++finalizedCount;
 
-TEST_CASE_METHOD(DukCppTest, "Class binding")
-{
-  duk_push_global_object(ctx_);
+    return 0;
+  };
 
-  auto prototypeHandle = registerVector(ctx_, -1);
+  const auto makeObject = [&]()
+  {
+    duk::scoped_pop _(ctx_); // duk_push_object
+    duk_push_object(ctx_);
 
-  // Primitive constructor function
-  duk::push_function<duk::ctor<Vector>>(ctx_);
-  duk_put_prop_string(ctx_, -2, "makeVector");
+    duk_push_c_function(ctx_, finalizer, 1);
+    duk_set_finalizer(ctx_, -2);
 
-  duk::push(ctx_, Vector{}, prototypeHandle);
-  duk_put_prop_string(ctx_, -2, "v2");
+    return duk::thread_safe_handle(duk::handle(ctx_, -1));
+  };
 
-  duk::push(ctx_, std::make_shared<Vector>(1.0f, 1.0f), prototypeHandle);
-  duk_put_prop_string(ctx_, -2, "v4");
+  static constexpr int count = 100;
 
-  duk_pop(ctx_); // Pop global object
+  std::vector<duk::thread_safe_handle> handles;
+  for (int i = 0; i < count; ++i)
+    handles.push_back(makeObject());
 
-  duk_peval_string(ctx_, R"__(
-    var v1 = new Vector(1, 2);
-    v1.add(2);
-    v1.length();
-  )__");
-  REQUIRE(equals(duk::get<double>(ctx_, -1), 5.0, 1e-5));
-  duk_pop(ctx_);
+  // Copies made and destroyed on other threads.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([handles]() mutable
+    {
+      auto copies = handles;
+      handles.clear();
+    });
+  }
 
-  duk_peval_string(ctx_, R"__(
-    v1.add(new Vector(2, 8));
-    v1.length();
-  )__");
-  REQUIRE(equals(duk::get<double>(ctx_, -1), 13.0, 1e-5));
-  duk_pop(ctx_);
+  for (auto& thread : threads)
+    thread.join();
 
-  duk_peval_string(ctx_, R"__(
-    v3 = makeVector();
-    v3.length();
-    v1.add(v3);
-    v1 instanceof Vector && v2 instanceof Vector && v3 instanceof Vector;
-  )__");
-  REQUIRE(duk::get<bool>(ctx_, -1) == true);
-  duk_pop(ctx_);
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == 0);
 
-  duk_peval_string(ctx_, R"__(
-    addVector(v4, new Vector(2, 3)).length()
-  )__");
-  REQUIRE(equals(duk::get<float>(ctx_, -1), 5.0f, 1e-5f));
-  duk_pop(ctx_);
+  // Last references released on another thread only get queued.
+  std::thread([handles = std::move(handles)]() mutable
+  {
+    handles.clear();
+  }).join();
 
-  duk_peval_string(ctx_, R"__(
-    v4.x = 100;
-    v4.x;
-  )__");
-  REQUIRE(equals(duk::get<double>(ctx_, -1), 100.0, 1e-5));
-  duk_pop(ctx_);
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == 0);
 
-  duk_peval_string(ctx_, R"__(
-    v4 = new Vector(4, 5);
-    var v5 = v4.sub(1);
+  duk::drain_releases(ctx_);
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == count);
+
+  // Released on the owning thread right away.
+  makeObject();
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == count + 1);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "thread_safe_handle outliving heap")
+{
+  static int finalizedCount;
+  finalizedCount = 0;
+
+  static constexpr auto finalizer = [](duk_context*) -> duk_ret_t
+  {
+    ++finalizedCount;
+
+    return 0;
+  };
+
+  auto ctx = duk_create_heap(Allocator::alloc, Allocator::realloc, Allocator::free, &allocator_, errorHandler);
+
+  const auto makeObject = [ctx]()
+  {
+    duk::scoped_pop _(ctx); // duk_push_object
+    duk_push_object(ctx);
+
+    duk_push_c_function(ctx, finalizer, 1);
+    duk_set_finalizer(ctx, -2);
+
+    return duk::thread_safe_handle(duk::handle(ctx, -1));
+  };
+
+  auto queued = makeObject();
+  auto releasedElsewhere = makeObject();
+  auto releasedHere = makeObject();
+
+  std::thread([queued = std::move(queued)]() mutable
+  {
+    queued = {};
+  }).join();
+
+  // Heap destroyed without duk::context, so nothing drains the release queue before.
+  duk_destroy_heap(ctx);
+  REQUIRE(finalizedCount == 3);
+
+  std::thread([releasedElsewhere = std::move(releasedElsewhere)]() mutable
+  {
+    releasedElsewhere = {};
+  }).join();
+
+  releasedHere = {};
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "weak_handle")
+{
+  duk::weak_handle empty;
+  REQUIRE(empty.expired());
+  REQUIRE(empty.lock().empty());
+
+  SECTION("Plain object")
+  {
+    duk_push_object(ctx_);
+    auto weakHandle = duk::weak_handle(duk::handle(ctx_, -1));
+    auto copy = weakHandle;
+
+    REQUIRE(!weakHandle.expired());
+    REQUIRE(weakHandle == copy);
+
+    {
+      auto safeHandle = weakHandle.lock();
+      REQUIRE(safeHandle.heap_ptr() == weakHandle.heap_ptr());
+
+      duk_pop(ctx_);
+      duk_gc(ctx_, 0);
+      REQUIRE(!weakHandle.expired());
+    }
+
+    duk_gc(ctx_, 0);
+    REQUIRE(weakHandle.expired());
+    REQUIRE(copy.expired());
+    REQUIRE(weakHandle.lock().empty());
+
+    // Reused slot doesn't bring expired handles back.
+    duk_push_object(ctx_);
+    auto weakHandle2 = duk::weak_handle(duk::handle(ctx_, -1));
+    REQUIRE(!weakHandle2.expired());
+    REQUIRE(weakHandle.expired());
+    duk_pop(ctx_);
+  }
+
+  SECTION("Native object")
+  {
+    Lifetime::Observer observer;
+    duk::push(ctx_, Lifetime{observer});
+
+    auto weakHandle = duk::weak_handle(duk::handle(ctx_, -1));
+
+    duk_pop(ctx_);
+    duk_gc(ctx_, 0);
+    REQUIRE(weakHandle.expired());
+    REQUIRE(observer.ctorDtorCountMatch());
+  }
+
+  SECTION("Foreign finalizer")
+  {
+    static int finalizedCount = 0;
+    finalizedCount = 0;
+
+    static constexpr auto finalizer = [](duk_context*) -> duk_ret_t
+    {
+      ++finalizedCount;
+
+      return 0;
+    };
+
+    duk_push_object(ctx_);
+    duk_push_c_function(ctx_, finalizer, 2);
+    duk_set_finalizer(ctx_, -2);
+
+    // Replaced finalizer is still called, once the handle has expired.
+    auto weakHandle = duk::weak_handle(duk::handle(ctx_, -1));
+    REQUIRE(!weakHandle.expired());
+
+    duk_pop(ctx_);
+    duk_gc(ctx_, 0);
+    REQUIRE(weakHandle.expired());
+    REQUIRE(finalizedCount == 1);
+  }
+
+  SECTION("Frozen object")
+  {
+    // Object without a finalizer can't get one.
+    duk_peval_string(ctx_, "Object.freeze({})");
+    REQUIRE_THROWS_AS(duk::weak_handle(duk::handle(ctx_, -1)), duk::error);
+    duk_pop(ctx_);
+
+    // Native object already has one, so it doesn't need to be changed.
+    Lifetime::Observer observer;
+    duk::push(ctx_, Lifetime{observer});
+    duk_freeze(ctx_, -1);
+
+    auto weakHandle = duk::weak_handle(duk::handle(ctx_, -1));
+    REQUIRE(!weakHandle.expired());
+
+    duk_pop(ctx_);
+    duk_gc(ctx_, 0);
+    REQUIRE(weakHandle.expired());
+    REQUIRE(observer.ctorDtorCountMatch());
+  }
+
+  SECTION("Inherited finalizer")
+  {
+    duk_peval_string(ctx_, "var parent = {}; (parent)");
+    auto parentHandle = duk::weak_handle(duk::handle(ctx_, -1));
+    duk_pop(ctx_);
+
+    duk_peval_string(ctx_, "var child = Object.create(parent); (child)");
+    auto childHandle = duk::weak_handle(duk::handle(ctx_, -1));
+    duk_pop(ctx_);
+
+    // Child keeps a finalizer of its own, even once it stops inheriting one.
+    duk_peval_string(ctx_, "Object.setPrototypeOf(child, {}); child = undefined");
+    duk_pop(ctx_);
+
+    duk_gc(ctx_, 0);
+    REQUIRE(childHandle.expired());
+    REQUIRE(!parentHandle.expired());
+  }
+
+  SECTION("Registered prototype")
+  {
+    struct Registered
+    {
+    };
+
+    duk_push_object(ctx_);
+    duk::register_prototype<Registered>(ctx_, -1);
+
+    auto weakHandle = duk::weak_handle(duk::handle(ctx_, -1));
+    REQUIRE(!weakHandle.expired());
+    duk_pop(ctx_); // Pop prototype
+
+    // Instances still get the object finalizer of their own.
+    duk::push(ctx_, Registered{});
+    auto instanceHandle = duk::weak_handle(duk::handle(ctx_, -1));
+
+    duk_pop(ctx_);
+    duk_gc(ctx_, 0);
+    REQUIRE(instanceHandle.expired());
+    REQUIRE(!weakHandle.expired());
+  }
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "handle_vector")
+{
+  static int finalizedCount;
+  finalizedCount = 0;
+
+  static constexpr auto finalizer = [](duk_context*) -> duk_ret_t
+  {
+    ++finalizedCount;
+
+    return 0;
+  };
+
+  static constexpr auto getObjectId = [](const duk::handle& handle)
+  {
+    auto ctx = handle.ctx();
+
+    duk::scoped_pop _(ctx, 2); // push_handle, duk_get_prop_index
+    push_handle(handle);
+    duk_get_prop_index(ctx, -1, 0);
+
+    return duk_get_int(ctx, -1);
+  };
+
+  static constexpr int count = 1000;
+
+  auto handles = duk::handle_vector(ctx_);
+  handles.reserve(count);
+
+  for (int i = 0; i < count; ++i)
+  {
+    duk::scoped_pop _(ctx_); // duk_push_object
+    duk_push_object(ctx_);
+
+    duk_push_int(ctx_, i);
+    duk_put_prop_index(ctx_, -2, 0);
+
+    duk_push_c_function(ctx_, finalizer, 1);
+    duk_set_finalizer(ctx_, -2);
+
+    handles.push_back(duk::handle(ctx_, -1));
+  }
+
+  duk_gc(ctx_, 0);
+  REQUIRE(handles.size() == count);
+  REQUIRE(finalizedCount == 0);
+  REQUIRE(getObjectId(handles[10]) == 10);
+
+  // Last value takes place of the erased one.
+  handles.erase(10);
+  duk_gc(ctx_, 0);
+  REQUIRE(handles.size() == count - 1);
+  REQUIRE(finalizedCount == 1);
+  REQUIRE(getObjectId(handles[10]) == count - 1);
+
+  handles.pop_back();
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == 2);
+
+  auto moved = std::move(handles);
+  duk_gc(ctx_, 0);
+  REQUIRE(finalizedCount == 2);
+  REQUIRE(getObjectId(moved[0]) == 0);
+
+  moved.clear();
+  duk_gc(ctx_, 0);
+  REQUIRE(moved.empty());
+  REQUIRE(finalizedCount == count);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Allocator")
+{
+  using string = std::basic_string<char, std::char_traits<char>, duk::allocator<char>>;
+
+  auto s1 = string{"s1", duk::allocator<char>(ctx_)};
+  auto s2 = string{"s2", duk::allocator<char>(ctx_)};
+
+  REQUIRE(s1 + s2 == "s1s2");
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Safe handle (function)")
+{
+  duk_peval_string(ctx_, "function f() { return 123; }; (f);");
+
+  auto funcHandle = duk::safe_handle(duk::handle(ctx_, -1));
+
+  duk_pop(ctx_); // Pop function.
+
+  // Make sure function is available for reclamation by gc.
+  // https://duktape.org/guide#limitations.12
+  duk_peval_string(ctx_, "f.prototype = null; f = null;");
+
+  duk_gc(ctx_, 0);
+
+  auto func = duk::safe_function_handle<int>(funcHandle);
+
+  REQUIRE(func() == 123);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Push and get std::string")
+{
+  duk::push(ctx_, std::string("test string"));
+  REQUIRE(duk::get<std::string>(ctx_, -1) == "test string");
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Push and get std::string_view")
+{
+  duk::push(ctx_, std::string_view("test string"));
+  REQUIRE(duk::get<std::string_view>(ctx_, -1) == "test string");
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Push and get const char*")
+{
+  duk::push(ctx_, "test string");
+  REQUIRE(std::strcmp(duk::get<const char*>(ctx_, -1), "test string") == 0);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Class binding")
+{
+  duk_push_global_object(ctx_);
+
+  auto prototypeHandle = registerVector(ctx_, -1);
+
+  // Primitive constructor function
+  duk::push_function<duk::ctor<Vector>>(ctx_);
+  duk_put_prop_string(ctx_, -2, "makeVector");
+
+  duk::push(ctx_, Vector{}, prototypeHandle);
+  duk_put_prop_string(ctx_, -2, "v2");
+
+  duk::push(ctx_, std::make_shared<Vector>(1.0f, 1.0f), prototypeHandle);
+  duk_put_prop_string(ctx_, -2, "v4");
+
+  duk_pop(ctx_); // Pop global object
+
+  duk_peval_string(ctx_, R"__(
+    var v1 = new Vector(1, 2);
+    v1.add(2);
+    v1.length();
+  )__");
+  REQUIRE(equals(duk::get<double>(ctx_, -1), 5.0, 1e-5));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, R"__(
+    v1.add(new Vector(2, 8));
+    v1.length();
+  )__");
+  REQUIRE(equals(duk::get<double>(ctx_, -1), 13.0, 1e-5));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, R"__(
+    v3 = makeVector();
+    v3.length();
+    v1.add(v3);
+    v1 instanceof Vector && v2 instanceof Vector && v3 instanceof Vector;
+  )__");
+  REQUIRE(duk::get<bool>(ctx_, -1) == true);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, R"__(
+    addVector(v4, new Vector(2, 3)).length()
+  )__");
+  REQUIRE(equals(duk::get<float>(ctx_, -1), 5.0f, 1e-5f));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, R"__(
+    v4.x = 100;
+    v4.x;
+  )__");
+  REQUIRE(equals(duk::get<double>(ctx_, -1), 100.0, 1e-5));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, R"__(
+    v4 = new Vector(4, 5);
+    var v5 = v4.sub(1);
     v5.length();
   )__");
   REQUIRE(equals(duk::get<double>(ctx_, -1), 5.0, 1e-5));
@@ -858,7 +1554,8 @@ TEST_CASE_METHOD(DukCppTest, "Inheritance")
 
 TEMPLATE_TEST_CASE_METHOD(DukCppTemplateTest, "Manual finalization", "",
   Lifetime,
-  CallableLifetime
+  CallableLifetime,
+  InlineLifetime
 )
 {
   auto& ctx = DukCppTest::ctx_;
@@ -877,36 +1574,330 @@ TEMPLATE_TEST_CASE_METHOD(DukCppTemplateTest, "Manual finalization", "",
 }
 
 
-TEST_CASE_METHOD(DukCppTest, "Clone")
+TEST_CASE_METHOD(DukCppTest, "Class builder")
 {
-  static constexpr auto cloneWrap = [](duk_context* ctx) -> duk_ret_t
+  struct Counter
   {
-    duk::clone(ctx, -1);
+    int get() const { return value; }
+    void set(const int& v) { value = v; }
 
-    return 1;
+    int value = 0;
+    int step = 1;
   };
 
-  duk_push_global_object(ctx_);
+  static constexpr auto make = [](int value) { return Counter{ .value = value }; };
+  static constexpr auto increment = [](Counter& self) { self.value += self.step; };
 
-  auto prototypeHandle = registerVector(ctx_, -1);
+  duk_push_global_object(ctx_);
 
-  duk_push_c_function(ctx_, cloneWrap, 1);
-  duk_put_prop_literal(ctx_, -2, "clone");
+  duk::class_<Counter,
+    duk::constructor<duk::ctor<Counter>>,
+    duk::static_method<"make", make>,
+    duk::method<"increment", increment>,
+    duk::property<"step", &Counter::step>,
+    duk::property_method<"value", &Counter::get, &Counter::set>
+  >::put_prop(ctx_, -1, "Counter");
 
   duk_pop(ctx_); // Pop global object
 
-  SECTION("Non-adapted")
-  {
-    duk_peval_string(ctx_, R"__(
-      var v1 = new Vector(1, 1);
-      var c1 = clone(v1);
-      c1.x = 2;
-      c1.x;
-    )__");
-    REQUIRE(duk::get<int>(ctx_, -1) == 2);
+  REQUIRE(duk::get_prototype<Counter>(ctx_) != nullptr);
 
-    duk_peval_string(ctx_, R"__(
-      v1.x;
+  duk_peval_string(ctx_, "var c = Counter.make(10); c.step = 5; c.increment(); c.value");
+  REQUIRE(duk::get<int>(ctx_, -1) == 15);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "var d = new Counter(); d.value = 3; d.increment(); d.value");
+  REQUIRE(duk::get<int>(ctx_, -1) == 4);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "c instanceof Counter && d instanceof Counter");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Class builder (Vector)")
+{
+  duk_push_global_object(ctx_);
+  auto prototypeHandle = registerVectorClass(ctx_, -1);
+  duk_pop(ctx_); // Pop global object
+
+  // Instances don't add anything to the compacted prototype.
+  duk_push_heapptr(ctx_, prototypeHandle);
+  duk_get_finalizer(ctx_, -1);
+  REQUIRE(duk_is_undefined(ctx_, -1));
+  duk_pop_2(ctx_); // Pop finalizer and prototype
+
+  duk_peval_string(ctx_, R"__(
+    var v1 = new Vector(1, 2);
+    v1.add(2);
+    v1.length();
+  )__");
+  REQUIRE(equals(duk::get<double>(ctx_, -1), 5.0, 1e-5));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, R"__(
+    v1.x = 6;
+    var v2 = addVector(v1.sub(2), new Vector(0, 1));
+    v2 instanceof Vector && v2.x == 4 && v2.y == 3;
+  )__");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Class builder (inheritance)")
+{
+  auto assertEq = [this](const char* code, const char* result)
+  {
+    duk_peval_string(ctx_, code);
+    REQUIRE(duk::get<std::string>(ctx_, -1) == result);
+    duk_pop(ctx_);
+  };
+
+  static constexpr auto runMethodA = [](InhBase& obj) { return obj.methodA(); };
+
+  duk_push_global_object(ctx_);
+  registerInhClasses(ctx_, -1);
+  duk::put_prop_function<runMethodA>(ctx_, -1, "runMethodA");
+  duk_pop(ctx_); // Pop global object
+
+  duk_peval_string(ctx_, R"__(
+    var base = new InhBase();
+    var der = new InhDer();
+    var final = new InhFinal();
+  )__");
+  duk_pop(ctx_);
+
+  assertEq("base.methodA();", "BaseA");
+  assertEq("der.methodB();", "DerB");
+  assertEq("final.methodA();", "FinalA");
+  assertEq("final.methodB();", "FinalB");
+  assertEq("final.methodC();", "FinalC");
+  assertEq("runMethodA(final);", "FinalA");
+
+  duk_peval_string(ctx_, "final instanceof InhDer && final instanceof InhBase && !(der instanceof InhFinal)");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "base.methodC();") != 0); // Call failed with an error.
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Prototype registry")
+{
+  // Prototypes are registered per heap, so each heap can have its own bindings of the same type.
+  duk::context ctx2(duk_create_heap(Allocator::alloc, Allocator::realloc, Allocator::free, &allocator_, errorHandler));
+
+  duk_push_global_object(ctx_);
+  auto prototypeHandle = registerVector(ctx_, -1);
+  duk_pop(ctx_); // Pop global object
+
+  REQUIRE(duk::get_prototype<Vector>(ctx_) == prototypeHandle);
+  REQUIRE(duk::get_prototype<Vector>(ctx2) == nullptr);
+
+  duk_push_global_object(ctx2);
+  auto prototypeHandle2 = registerVector(ctx2, -1);
+  duk_pop(ctx2); // Pop global object
+
+  REQUIRE(duk::get_prototype<Vector>(ctx_) == prototypeHandle);
+  REQUIRE(duk::get_prototype<Vector>(ctx2) == prototypeHandle2);
+
+  for (duk_context* ctx : { static_cast<duk_context*>(ctx_), static_cast<duk_context*>(ctx2) })
+  {
+    // Returned object has no explicitly specified prototype.
+    duk_peval_string(ctx, "addVector(new Vector(1, 2), new Vector(2, 2)).length()");
+    REQUIRE(equals(duk::get<float>(ctx, -1), 5.0f, 1e-5f));
+    duk_pop(ctx);
+  }
+
+  // Register enough types to make the registry grow. Registered prototypes are kept alive by the registry.
+  [this]<int ...i>(std::integer_sequence<int, i...>)
+  {
+    ((
+      duk_push_object(ctx_),
+      duk::put_prop(ctx_, -1, "i", i),
+      duk::register_prototype<std::integral_constant<int, i>>(ctx_, -1),
+      duk_pop(ctx_)
+    ), ...);
+
+    duk_gc(ctx_, 0);
+
+    int expected = 0;
+    for (auto heapPtr : { duk::get_prototype<std::integral_constant<int, i>>(ctx_)... })
+    {
+      duk_push_heapptr(ctx_, heapPtr);
+      duk_get_prop_literal(ctx_, -1, "i");
+      REQUIRE(duk::get<int>(ctx_, -1) == expected++);
+      duk_pop_2(ctx_);
+    }
+  }(std::make_integer_sequence<int, 32>());
+
+  REQUIRE(duk::get_prototype<Vector>(ctx_) == prototypeHandle);
+
+  // Registering another prototype replaces the previous one.
+  duk_push_object(ctx_);
+  auto newPrototypeHandle = duk_get_heapptr(ctx_, -1);
+  duk::register_prototype<Vector>(ctx_, -1);
+  duk_pop(ctx_);
+
+  REQUIRE(duk::get_prototype<Vector>(ctx_) == newPrototypeHandle);
+}
+
+
+struct StaticPrototype
+{
+};
+
+
+template<>
+struct duk::class_traits_prototype<StaticPrototype>
+{
+  [[nodiscard]]
+  static void* get(duk_context*) noexcept
+  {
+    return heap_ptr;
+  }
+
+  inline static void* heap_ptr = nullptr;
+};
+
+
+TEST_CASE_METHOD(DukCppTest, "Static prototype")
+{
+  duk_push_object(ctx_);
+  duk::put_prop(ctx_, -1, "registered", true);
+  duk::register_prototype<StaticPrototype>(ctx_, -1);
+  duk_pop(ctx_);
+
+  duk_push_object(ctx_);
+  duk::put_prop(ctx_, -1, "static", true);
+  duk::class_traits_prototype<StaticPrototype>::heap_ptr = duk_get_heapptr(ctx_, -1);
+
+  // Specialized class_traits_prototype overrides the registry.
+  duk::push(ctx_, StaticPrototype{});
+  duk_get_prototype(ctx_, -1);
+  REQUIRE(duk_get_heapptr(ctx_, -1) == duk::class_traits_prototype<StaticPrototype>::heap_ptr);
+  duk_pop_2(ctx_);
+
+  duk_put_global_string(ctx_, "StaticPrototype");
+
+  duk::push(ctx_, StaticPrototype{});
+  duk_put_global_string(ctx_, "s");
+
+  duk_peval_string(ctx_, "s.static === true && s.registered === undefined");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk::class_traits_prototype<StaticPrototype>::heap_ptr = nullptr;
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Shared finalizer")
+{
+  const auto getFinalizer = [this](duk_idx_t idx)
+  {
+    duk_get_finalizer(ctx_, idx);
+    auto finalizer = duk_get_heapptr(ctx_, -1);
+    duk_pop(ctx_);
+
+    return finalizer;
+  };
+
+  duk_push_global_object(ctx_);
+  auto prototypeHandle = registerVector(ctx_, -1);
+  duk_pop(ctx_); // Pop global object
+
+  Lifetime::Observer observer;
+
+  duk::push(ctx_, Vector(1, 2));
+  duk::push(ctx_, Vector(3, 4));
+  duk::push(ctx_, Lifetime{observer});
+  duk::push(ctx_, CallableLifetime{observer});
+  duk::push(ctx_, CallableLifetime{observer});
+
+  // Objects share a finalizer, installed on each of them rather than on their prototype.
+  duk_push_heapptr(ctx_, prototypeHandle);
+  REQUIRE(getFinalizer(-1) == nullptr);
+  duk_pop(ctx_);
+
+  auto objectFinalizer = getFinalizer(0);
+
+  REQUIRE(objectFinalizer != nullptr);
+  REQUIRE(getFinalizer(1) == objectFinalizer);
+  REQUIRE(getFinalizer(2) == objectFinalizer);
+
+  // Callables don't share a prototype, but they do share a finalizer.
+  REQUIRE(getFinalizer(3) != nullptr);
+  REQUIRE(getFinalizer(3) == getFinalizer(4));
+
+  duk_pop_2(ctx_);
+
+  // Objects inheriting from a wrapper inherit its finalizer too, but mustn't release the wrapped object.
+  duk_put_global_string(ctx_, "a");
+  duk_peval_string(ctx_, "var b = Object.create(a); b = null;");
+  duk_pop(ctx_);
+
+  duk_gc(ctx_, 0);
+
+  REQUIRE(observer.ctorDtorCountMatch() == false);
+
+  duk_get_global_string(ctx_, "a");
+  REQUIRE(duk::finalize(ctx_, -1) == true);
+  REQUIRE(observer.ctorDtorCountMatch() == true);
+  duk_pop(ctx_);
+
+  // Objects keep their finalizer when script code replaces their prototype.
+  Lifetime::Observer observer2;
+
+  duk_push_object(ctx_);
+  duk::register_prototype<Lifetime>(ctx_, -1);
+  duk_pop(ctx_);
+
+  duk::push(ctx_, Lifetime{observer2});
+  duk_put_global_string(ctx_, "l1");
+  duk::push(ctx_, Lifetime{observer2});
+  duk_put_global_string(ctx_, "l2");
+
+  duk_peval_string(ctx_, "Object.setPrototypeOf(l1, null); Object.setPrototypeOf(l2, {}); l1 = l2 = undefined");
+  duk_pop(ctx_);
+
+  duk_gc(ctx_, 0);
+
+  REQUIRE(observer2.ctorDtorCountMatch() == true);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Clone")
+{
+  static constexpr auto cloneWrap = [](duk_context* ctx) -> duk_ret_t
+  {
+    duk::clone(ctx, -1);
+
+    return 1;
+  };
+
+  duk_push_global_object(ctx_);
+
+  auto prototypeHandle = registerVector(ctx_, -1);
+
+  duk_push_c_function(ctx_, cloneWrap, 1);
+  duk_put_prop_literal(ctx_, -2, "clone");
+
+  duk_pop(ctx_); // Pop global object
+
+  SECTION("Non-adapted")
+  {
+    duk_peval_string(ctx_, R"__(
+      var v1 = new Vector(1, 1);
+      var c1 = clone(v1);
+      c1.x = 2;
+      c1.x;
+    )__");
+    REQUIRE(duk::get<int>(ctx_, -1) == 2);
+
+    duk_peval_string(ctx_, R"__(
+      v1.x;
     )__");
     REQUIRE(duk::get<int>(ctx_, -1) == 1);
   }
@@ -935,6 +1926,45 @@ TEST_CASE_METHOD(DukCppTest, "Clone")
 }
 
 
+TEST_CASE_METHOD(DukCppTest, "Mirrored properties")
+{
+  duk_push_global_object(ctx_);
+  duk::put_prop(ctx_, -1, "config", Config{ .limit = 10, .name = "rules", .enabled = true });
+  duk_pop(ctx_); // Pop global object
+
+  duk_peval_string(ctx_, "Object.getOwnPropertyDescriptor(config, 'limit').value === 10 && config.name === 'rules'");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "config.limit = 20; config.enabled = false; config");
+  auto& config = duk::get<Config>(ctx_, -1);
+
+  // Script writes only reach C++ object when synced.
+  REQUIRE(config.limit == 10);
+  REQUIRE(duk::sync(ctx_, -1));
+  REQUIRE(config.limit == 20);
+  REQUIRE(config.name == "rules");
+  REQUIRE(config.enabled == false);
+
+  config.name = "updated";
+  REQUIRE(duk::refresh(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "config.name");
+  REQUIRE(duk::get<std::string>(ctx_, -1) == "updated");
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "config.limit = 'none'; config");
+  REQUIRE_THROWS_AS(duk::sync(ctx_, -1), duk::error);
+  REQUIRE(config.limit == 20);
+  duk_pop(ctx_);
+
+  duk_push_object(ctx_);
+  REQUIRE(duk::sync(ctx_, -1) == false);
+  duk_pop(ctx_);
+}
+
+
 TEST_CASE_METHOD(DukCppTest, "Enum")
 {
   enum class Enum
@@ -1005,6 +2035,23 @@ TEST_CASE_METHOD(DukCppTest, "Properties")
   )__");
   REQUIRE(duk::get<Vector>(ctx_, -1) == Vector(10, 20));
   duk_pop(ctx_);
+
+  // Accessors check types of both `this` and assigned value.
+  REQUIRE(duk_peval_string(ctx_, "c.id = 'text';") != 0);
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "c.position = 1;") != 0);
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, R"__(
+    Object.getOwnPropertyDescriptor(Character.prototype, 'id').get.call(new Vector());
+  )__") != 0);
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, R"__(
+    Object.getOwnPropertyDescriptor(Character.prototype, 'active').set.call({}, true);
+  )__") != 0);
+  duk_pop(ctx_);
 }
 
 
@@ -1110,65 +2157,310 @@ TEST_CASE_METHOD(DukCppTest, "Ranges (std::random_access_iterator)")
 }
 
 
-TEST_CASE_METHOD(DukCppTest, "Ranges (sum)")
+TEST_CASE_METHOD(DukCppTest, "Array snapshot")
 {
+  static constexpr auto sum = [](const duk::array_snapshot<int>& values)
+  {
+    return std::accumulate(values.begin(), values.end(), 0);
+  };
+
   duk_push_global_object(ctx_);
+  duk::put_prop_function<sum>(ctx_, -1, "sum");
+  duk_pop(ctx_); // Pop global object
 
-  constexpr static auto sumRange = [](duk::safe_input_range<int> r)
-  {
-    int sum = 0;
+  duk_peval_string(ctx_, "var a = []; for (var i = 0; i < 1000; ++i) a.push(i); a");
 
-    for (auto i : r)
-      sum += i;
+  auto top = duk_get_top(ctx_);
 
-    return sum;
-  };
+  auto snapshot = duk::get<duk::array_snapshot<double>>(ctx_, -1);
+  REQUIRE(duk_get_top(ctx_) == top);
+  REQUIRE(snapshot.size() == 1000);
+  REQUIRE(snapshot.data()[999] == 999.0);
+  REQUIRE(std::accumulate(snapshot.begin(), snapshot.end(), 0.0) == 499500.0);
 
-  static constexpr auto sumRanges = [](duk::safe_input_range<int> r1, duk::safe_input_range<int> r2)
-  {
-    std::string result;
+  auto values = snapshot.release();
+  REQUIRE(values.size() == 1000);
+  duk_pop(ctx_);
 
-    for (auto iter1 = r1.begin(), iter2 = r2.begin(); iter1 != r1.end(); ++iter1, ++iter2)
-      result += std::to_string(*iter1 + *iter2) + " ";
+  duk_peval_string(ctx_, "sum(a)");
+  REQUIRE(duk::get<int>(ctx_, -1) == 499500);
+  duk_pop(ctx_);
 
-    return result;
-  };
+  duk_peval_string(ctx_, "sum([])");
+  REQUIRE(duk::get<int>(ctx_, -1) == 0);
+  duk_pop(ctx_);
 
-  duk::put_prop_function<sumRange>(ctx_, -1, "sumRange");
-  duk::put_prop_function<sumRanges>(ctx_, -1, "sumRanges");
+  duk_peval_string(ctx_, "[1, 'a', 3]");
+  REQUIRE_THROWS_AS(duk::get<duk::array_snapshot<int>>(ctx_, -1), duk::error);
+  duk_pop(ctx_);
+}
 
-  duk_pop(ctx_); // Pop global object
 
-  SECTION("Array")
+TEST_CASE_METHOD(DukCppTest, "Typed array spans")
+{
+  static constexpr auto sum = [](std::span<const float> values)
   {
-    duk_peval_string(ctx_, R"__(
-      sumRange([1, 2, 3]);
-    )__");
-    REQUIRE(duk::get<int>(ctx_, -1) == 6);
-    duk_pop(ctx_);
-
-    duk_peval_string(ctx_, R"__(
-      sumRanges([1, 2, 3], [10, 20, 30]);
-    )__");
-    REQUIRE(duk::get<std::string>(ctx_, -1) == "11 22 33 ");
-    duk_pop(ctx_);
-  }
+    return std::accumulate(values.begin(), values.end(), 0.0f);
+  };
 
-  SECTION("Iterable ES object")
+  static constexpr auto scale = [](std::span<float> values, float factor)
   {
-    duk_peval_string(ctx_, R"__(
-      var iterableObject = {
-        [Symbol.iterator]: function()
-        {
-          return {
-            n: 0,
-            next: function()
-            {
-              var done = false;
-              if (this.n == 5)
-                done = true;
+    for (auto& value : values)
+      value *= factor;
+  };
 
-              return { value: this.n++, done };
+  duk_push_global_object(ctx_);
+  duk::put_prop_function<sum>(ctx_, -1, "sum");
+  duk::put_prop_function<scale>(ctx_, -1, "scale");
+  duk_pop(ctx_); // Pop global object
+
+  duk_peval_string(ctx_, "var a = new Float32Array([1, 2, 3, 4]); sum(a)");
+  REQUIRE(duk::get<float>(ctx_, -1) == 10.0f);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "scale(a, 2); a[3]");
+  REQUIRE(duk::get<float>(ctx_, -1) == 8.0f);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "sum(new Float32Array(new ArrayBuffer(16), 4, 2))");
+  REQUIRE(duk::get<float>(ctx_, -1) == 0.0f);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "new Uint8Array([1, 2, 3]).buffer");
+  REQUIRE(duk::check_type<std::span<std::byte>>(ctx_, -1));
+  REQUIRE(!duk::check_type<std::span<std::uint8_t>>(ctx_, -1));
+  auto bytes = duk::get<std::span<std::byte>>(ctx_, -1);
+  REQUIRE(bytes.size() == 3);
+  REQUIRE(bytes[2] == std::byte{3});
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "new Uint8ClampedArray([1, 2])");
+  REQUIRE(duk::check_type<std::span<const std::uint8_t>>(ctx_, -1));
+  REQUIRE(duk::check_type<std::span<std::byte>>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "new Float64Array([1, 2])");
+  REQUIRE(!duk::check_type<std::span<float>>(ctx_, -1));
+  REQUIRE(duk::check_type<std::span<double>>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "[1, 2]");
+  REQUIRE(!duk::check_type<std::span<float>>(ctx_, -1));
+  REQUIRE(!duk::check_type<std::span<std::byte>>(ctx_, -1));
+  duk_pop(ctx_);
+
+  // Element type is decided by the built-in prototype, which replacing global constructors doesn't change.
+  duk_peval_string(ctx_, "var f = new Float32Array(2); Float32Array = Array; (f)");
+  REQUIRE(duk::check_type<std::span<float>>(ctx_, -1));
+  REQUIRE(!duk::check_type<std::span<std::int32_t>>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "Object.setPrototypeOf(f, Object.prototype); (f)");
+  REQUIRE(!duk::check_type<std::span<float>>(ctx_, -1));
+  REQUIRE(duk::check_type<std::span<std::byte>>(ctx_, -1));
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "sum([1, 2])") != DUK_EXEC_SUCCESS);
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Typed array push")
+{
+  static std::size_t destroyedCount = 0;
+
+  struct Samples : std::vector<float>
+  {
+    using std::vector<float>::vector;
+
+    Samples(Samples&&) = default;
+
+    ~Samples()
+    {
+      if (!empty())
+        ++destroyedCount;
+    }
+  };
+
+  static constexpr auto decode = [](int count)
+  {
+    Samples samples(count);
+    std::iota(samples.begin(), samples.end(), 0.0f);
+
+    return duk::typed_array(std::move(samples));
+  };
+
+  static constexpr auto copy = [](int count)
+  {
+    static const std::vector<std::uint8_t> bytes(16, 7);
+
+    return std::span(bytes).first(count);
+  };
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function<decode>(ctx_, -1, "decode");
+  duk::put_prop_function<copy>(ctx_, -1, "copy");
+  duk_pop(ctx_); // Pop global object
+
+  std::vector<float> values = { 1.0f, 2.0f, 3.0f };
+  auto data = values.data();
+
+  duk::push(ctx_, duk::typed_array(std::move(values)));
+  REQUIRE(duk::check_type<std::span<float>>(ctx_, -1));
+  auto view = duk::get<std::span<float>>(ctx_, -1);
+  REQUIRE(view.data() == data);
+  REQUIRE(view.size() == 3);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "var s = decode(1000); s instanceof Float32Array && s.length == 1000 && s[999] == 999");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "var t = s.subarray(10, 20); s = undefined; t[0] = -1; t.buffer.byteLength");
+  REQUIRE(duk::get<int>(ctx_, -1) == 4000);
+  duk_pop(ctx_);
+
+  duk_gc(ctx_, 0);
+  duk_gc(ctx_, 0);
+  REQUIRE(destroyedCount == 0);
+
+  duk_peval_string(ctx_, "t[0] + t[9]");
+  REQUIRE(duk::get<int>(ctx_, -1) == 18);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "t = undefined");
+  duk_pop(ctx_);
+
+  duk_gc(ctx_, 0);
+  duk_gc(ctx_, 0);
+  REQUIRE(destroyedCount == 1);
+
+  duk_peval_string(ctx_, "decode(0).length");
+  REQUIRE(duk::get<int>(ctx_, -1) == 0);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "var c = copy(4); c instanceof Uint8Array && c.length == 4 && c[3] == 7");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  // Views reachable after their owner is finalized are detached from the released storage.
+  duk_peval_string(ctx_, "decode(4)");
+  duk_get_prop_literal(ctx_, -1, "buffer");
+  duk_get_finalizer(ctx_, -1);
+  duk_dup(ctx_, -2);
+  duk_call(ctx_, 1);
+  duk_pop_2(ctx_); // Pop finalizer result and ArrayBuffer
+  REQUIRE(destroyedCount == 2);
+  REQUIRE(duk::get<std::span<float>>(ctx_, -1).empty());
+  duk_put_global_string(ctx_, "d");
+
+  duk_peval_string(ctx_, "d[3] = 5; d[3] !== 3 && d[3] !== 5");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "d = undefined");
+  duk_pop(ctx_);
+
+  duk_gc(ctx_, 0);
+  duk_gc(ctx_, 0);
+  REQUIRE(destroyedCount == 2);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Array output")
+{
+  static_assert(std::output_iterator<duk::array_output_iterator<int>, int>);
+
+  std::vector<int> values = { 1, 2, 3 };
+
+  duk_push_array(ctx_);
+
+  auto out = std::ranges::copy(values, duk::array_output_iterator<int>(ctx_, -1)).out;
+  REQUIRE(out.index() == 3);
+
+  std::transform(values.begin(), values.end(), out, [](int value) { return value * 10; });
+  REQUIRE(duk_get_length(ctx_, -1) == 6);
+
+  duk_get_prop_index(ctx_, -1, 5);
+  REQUIRE(duk::get<int>(ctx_, -1) == 30);
+  duk_pop_2(ctx_);
+
+  auto top = duk_get_top(ctx_);
+
+  duk::push_range(ctx_, values | std::views::transform([](int value) { return std::to_string(value); }));
+  REQUIRE(duk_get_top(ctx_) == top + 1);
+  REQUIRE(duk_is_array(ctx_, -1));
+  REQUIRE(duk_get_length(ctx_, -1) == 3);
+
+  duk_get_prop_index(ctx_, -1, 1);
+  REQUIRE(duk::get<std::string>(ctx_, -1) == "2");
+  duk_pop_2(ctx_);
+
+  duk::push_range(ctx_, std::vector<int>{});
+  REQUIRE(duk_get_length(ctx_, -1) == 0);
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Ranges (sum)")
+{
+  duk_push_global_object(ctx_);
+
+  constexpr static auto sumRange = [](duk::safe_input_range<int> r)
+  {
+    int sum = 0;
+
+    for (auto i : r)
+      sum += i;
+
+    return sum;
+  };
+
+  static constexpr auto sumRanges = [](duk::safe_input_range<int> r1, duk::safe_input_range<int> r2)
+  {
+    std::string result;
+
+    for (auto iter1 = r1.begin(), iter2 = r2.begin(); iter1 != r1.end(); ++iter1, ++iter2)
+      result += std::to_string(*iter1 + *iter2) + " ";
+
+    return result;
+  };
+
+  duk::put_prop_function<sumRange>(ctx_, -1, "sumRange");
+  duk::put_prop_function<sumRanges>(ctx_, -1, "sumRanges");
+
+  duk_pop(ctx_); // Pop global object
+
+  SECTION("Array")
+  {
+    duk_peval_string(ctx_, R"__(
+      sumRange([1, 2, 3]);
+    )__");
+    REQUIRE(duk::get<int>(ctx_, -1) == 6);
+    duk_pop(ctx_);
+
+    duk_peval_string(ctx_, R"__(
+      sumRanges([1, 2, 3], [10, 20, 30]);
+    )__");
+    REQUIRE(duk::get<std::string>(ctx_, -1) == "11 22 33 ");
+    duk_pop(ctx_);
+  }
+
+  SECTION("Iterable ES object")
+  {
+    duk_peval_string(ctx_, R"__(
+      var iterableObject = {
+        [Symbol.iterator]: function()
+        {
+          return {
+            n: 0,
+            next: function()
+            {
+              var done = false;
+              if (this.n == 5)
+                done = true;
+
+              return { value: this.n++, done };
             }
           };
         }
@@ -1309,6 +2601,398 @@ TEST_CASE_METHOD(DukCppTest, "Iterable native object")
 }
 
 
+TEST_CASE_METHOD(DukCppTest, "Native iterator objects")
+{
+  static constexpr auto make_list = []()
+  {
+    return std::list<int>{ 1, 2, 3 };
+  };
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function<make_list>(ctx_, -1, "make_list");
+  duk_pop(ctx_); // Pop global object
+
+  duk_peval_string(ctx_, R"__(
+    var list = make_list();
+    var iter1 = list[Symbol.iterator]();
+    var iter2 = make_list()[Symbol.iterator]();
+
+    Object.getPrototypeOf(iter1) === Object.getPrototypeOf(iter2) && iter1.next === iter2.next;
+  )__");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  // Iterated object is kept alive by its iterator.
+  duk_gc(ctx_, 0);
+
+  duk_peval_string(ctx_, R"__(
+    var sum = 0;
+    var result = iter2.next();
+    var sameResult = true;
+
+    while (!result.done)
+    {
+      sum += result.value;
+
+      var next = iter2.next();
+      sameResult = sameResult && next === result;
+      result = next;
+    }
+
+    sameResult && sum == 6 && iter2.next().done && iter2.next().value === undefined;
+  )__");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, R"__(
+    try
+    {
+      iter1.next.call({});
+      false;
+    }
+    catch (e)
+    {
+      e instanceof TypeError;
+    }
+  )__");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "iter1 = iter2 = list = undefined");
+  duk_pop(ctx_);
+
+  duk_gc(ctx_, 0);
+  duk_gc(ctx_, 0);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Iterable prototype")
+{
+  static constexpr auto make_list = []()
+  {
+    return std::list<int>{ 1, 2, 3 };
+  };
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function<make_list>(ctx_, -1, "make_list");
+  duk_pop(ctx_); // Pop global object
+
+  duk_push_object(ctx_);
+  duk::register_prototype<std::list<int>>(ctx_, -1);
+  duk_put_global_string(ctx_, "ListPrototype");
+
+  duk_peval_string(ctx_, R"__(
+    var list1 = make_list();
+    var list2 = make_list();
+
+    var iterator = ListPrototype[Symbol.iterator];
+    var iter = list2[Symbol.iterator]();
+    var sum = 0;
+
+    for (var result = iter.next(); !result.done; result = iter.next())
+      sum += result.value;
+
+    typeof iterator == 'function' &&
+      Object.getPrototypeOf(list1) === ListPrototype &&
+      list1[Symbol.iterator] === iterator &&
+      list2[Symbol.iterator] === iterator &&
+      !list1.hasOwnProperty(Symbol.iterator) &&
+      sum == 6;
+  )__");
+  REQUIRE(duk::get<bool>(ctx_, -1));
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "list1");
+
+  int sum = 0;
+  for (auto i : duk::get<duk::input_range<int>>(ctx_, -1))
+    sum += i;
+
+  REQUIRE(sum == 6);
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Ranges (native iteration)")
+{
+  static constexpr auto make_list = []()
+  {
+    return std::list<int>{ 1, 2, 3 };
+  };
+
+  static constexpr auto sum = [](duk::safe_symbol_input_range<int> r)
+  {
+    int sum = 0;
+
+    for (auto i : r)
+      sum += i;
+
+    return sum;
+  };
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function<make_list>(ctx_, -1, "make_list");
+  duk::put_prop_function<sum>(ctx_, -1, "sum");
+  duk_pop(ctx_); // Pop global object
+
+  SECTION("Wrapped C++ range")
+  {
+    duk_peval_string(ctx_, "sum(make_list())");
+    REQUIRE(duk::get<int>(ctx_, -1) == 6);
+    duk_pop(ctx_);
+
+    duk_peval_string(ctx_, "make_list()");
+
+    auto top = duk_get_top(ctx_);
+
+    std::vector<int> values;
+    for (auto i : duk::get<duk::input_range<int>>(ctx_, -1))
+      values.push_back(i);
+
+    REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+    REQUIRE(duk_get_top(ctx_) == top);
+    duk_pop(ctx_);
+
+    // Objects inheriting from the wrapper iterate the same C++ range.
+    duk_peval_string(ctx_, "sum(Object.create(make_list()))");
+    REQUIRE(duk::get<int>(ctx_, -1) == 6);
+    duk_pop(ctx_);
+  }
+
+  SECTION("Overridden Symbol.iterator")
+  {
+    duk_peval_string(ctx_, R"__(
+      var list = make_list();
+      list[Symbol.iterator] = function()
+      {
+        return { next: function() { return { done: true }; } };
+      };
+
+      sum(list);
+    )__");
+    REQUIRE(duk::get<int>(ctx_, -1) == 0);
+    duk_pop(ctx_);
+  }
+
+  SECTION("Array")
+  {
+    duk_peval_string(ctx_, "sum([1, 2, 3, 4])");
+    REQUIRE(duk::get<int>(ctx_, -1) == 10);
+    duk_pop(ctx_);
+
+    duk_peval_string(ctx_, "sum([])");
+    REQUIRE(duk::get<int>(ctx_, -1) == 0);
+    duk_pop(ctx_);
+
+    duk_peval_string(ctx_, R"__(
+      var array = [1, 2, 3];
+      array[Symbol.iterator] = function()
+      {
+        var n = 0;
+
+        return { next: function() { return { value: 100, done: n++ == 1 }; } };
+      };
+
+      sum(array);
+    )__");
+    REQUIRE(duk::get<int>(ctx_, -1) == 100);
+    duk_pop(ctx_);
+
+    // Replaced global Array doesn't make arrays lose native iteration.
+    duk_peval_string(ctx_, "Array = function() {}; Array.prototype[Symbol.iterator] = null; sum([1, 2])");
+    REQUIRE(duk::get<int>(ctx_, -1) == 3);
+    duk_pop(ctx_);
+
+    // Replaced built-in iterator is used instead of reading elements by index.
+    duk_peval_string(ctx_, R"__(
+      Object.getPrototypeOf([])[Symbol.iterator] = function()
+      {
+        return { next: function() { return { done: true }; } };
+      };
+
+      sum([1, 2]);
+    )__");
+    REQUIRE(duk::get<int>(ctx_, -1) == 0);
+    duk_pop(ctx_);
+  }
+
+  SECTION("Array (iterator replaced before heap state exists)")
+  {
+    auto rawCtx = duk_create_heap(Allocator::alloc, Allocator::realloc, Allocator::free, &allocator_, errorHandler);
+
+    duk_peval_string(rawCtx, R"__(
+      Array.prototype[Symbol.iterator] = function()
+      {
+        return { next: function() { return { done: true }; } };
+      };
+    )__");
+    duk_pop(rawCtx);
+
+    // Replacement isn't mistaken for the built-in iterator.
+    duk::context ctx2(rawCtx);
+
+    duk_push_global_object(ctx2);
+    duk::put_prop_function<sum>(ctx2, -1, "sum");
+    duk_pop(ctx2); // Pop global object
+
+    duk_peval_string(ctx2, "sum([1, 2])");
+    REQUIRE(duk::get<int>(ctx2, -1) == 0);
+    duk_pop(ctx2);
+  }
+
+  SECTION("Array (growing)")
+  {
+    duk_peval_string(ctx_, "var array = [1, 2, 3]; array");
+
+    int sum = 0;
+    for (auto i : duk::get<duk::symbol_input_range<int>>(ctx_, -1))
+    {
+      if (i == 3)
+      {
+        duk_peval_string(ctx_, "array.push(4)");
+        duk_pop(ctx_);
+      }
+
+      sum += i;
+    }
+
+    REQUIRE(sum == 10);
+    duk_pop(ctx_);
+  }
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Generators")
+{
+  static int producedCount = 0;
+
+  static constexpr auto naturals = []() -> duk::generator<int>
+  {
+    for (int i = 0; ; ++i)
+    {
+      ++producedCount;
+      co_yield i;
+    }
+  };
+
+  static constexpr auto words = [](int count) -> duk::generator<const std::string&>
+  {
+    for (int i = 0; i < count; ++i)
+      co_yield "word" + std::to_string(i);
+  };
+
+  static constexpr auto failing = []() -> duk::generator<int>
+  {
+    co_yield 1;
+    throw std::runtime_error("generator failed");
+  };
+
+  static_assert(std::ranges::input_range<duk::generator<int>>);
+
+  duk_push_global_object(ctx_);
+  duk::put_prop_function<naturals>(ctx_, -1, "naturals");
+  duk::put_prop_function<words>(ctx_, -1, "words");
+  duk::put_prop_function<failing>(ctx_, -1, "failing");
+  duk_pop(ctx_); // Pop global object
+
+  SECTION("Infinite generator")
+  {
+    producedCount = 0;
+
+    duk_peval_string(ctx_, R"__(
+      var iter = naturals()[Symbol.iterator]();
+      var sum = 0;
+
+      for (var i = 0; i < 5; ++i)
+        sum += iter.next().value;
+
+      (sum);
+    )__");
+    REQUIRE(duk::get<int>(ctx_, -1) == 10);
+    REQUIRE(producedCount == 5);
+    duk_pop(ctx_);
+  }
+
+  SECTION("Finite generator")
+  {
+    duk_peval_string(ctx_, R"__(
+      var iter = words(3)[Symbol.iterator]();
+      var result = [];
+
+      for (var node = iter.next(); !node.done; node = iter.next())
+        result.push(node.value);
+
+      result.join(' ');
+    )__");
+    REQUIRE(duk::get<std::string>(ctx_, -1) == "word0 word1 word2");
+    duk_pop(ctx_);
+
+    duk_peval_string(ctx_, "words(2)");
+
+    std::vector<std::string> values;
+    for (auto&& value : duk::get<duk::input_range<std::string>>(ctx_, -1))
+      values.push_back(value);
+
+    REQUIRE(values == std::vector<std::string>{ "word0", "word1" });
+    duk_pop(ctx_);
+  }
+
+  SECTION("Generator throws")
+  {
+    duk_peval_string(ctx_, R"__(
+      var iter = failing()[Symbol.iterator]();
+      var first = iter.next().value;
+
+      try
+      {
+        iter.next();
+        false;
+      }
+      catch (e)
+      {
+        first == 1;
+      }
+    )__");
+    REQUIRE(duk::get<bool>(ctx_, -1));
+    duk_pop(ctx_);
+  }
+
+  SECTION("C++ iteration")
+  {
+    std::vector<std::string> values;
+
+    for (const auto& value : words(2))
+      values.push_back(value);
+
+    REQUIRE(values == std::vector<std::string>{ "word0", "word1" });
+  }
+
+  SECTION("Const lvalue")
+  {
+    struct Names
+    {
+      std::string first = "first";
+      std::string second = "second";
+    };
+
+    auto names = [](const Names& source) -> duk::generator<std::string>
+    {
+      co_yield source.first;
+      co_yield source.second;
+    };
+
+    const Names source;
+    std::vector<std::string> values;
+
+    for (auto& value : names(source))
+      values.push_back(std::move(value));
+
+    REQUIRE(values == std::vector<std::string>{ "first", "second" });
+    REQUIRE(source.first == "first");
+  }
+}
+
+
 TEST_CASE_METHOD(DukCppTest, "Generic object binding")
 {
   struct A
@@ -1341,3 +3025,141 @@ TEST_CASE_METHOD(DukCppTest, "Generic object binding")
   REQUIRE(duk_pcall(ctx_, 2) != DUK_EXEC_SUCCESS); // Call failed with an error.
   duk_pop(ctx_);
 }
+
+
+TEST_CASE_METHOD(DukCppTest, "Overloaded function (object arguments)")
+{
+  struct A
+  {
+    int m = 1;
+  };
+
+  struct B
+  {
+    int m = 2;
+  };
+
+  // Object arguments' ObjectInfo is resolved once per call and shared between all overloads. Make sure results
+  // don't get mixed up between overloads expecting different types at the same position, or between method and
+  // non-method signatures (`this` shifts argument positions on the value stack).
+  static constexpr auto fA = [](const A& a, int i) { return a.m * i; };
+  static constexpr auto fB = [](const A& a, const B& b) { return a.m + b.m; };
+  static constexpr auto mA = [](const B& self, const A& a) { return self.m * 100 + a.m; };
+
+  duk_push_global_object(ctx_);
+
+  duk::put_prop_function<fA, fB>(ctx_, -1, "f");
+
+  duk::push_function<duk::ctor<B>>(ctx_);
+  duk_push_object(ctx_); // prototype
+  duk::put_prop_method<mA>(ctx_, -1, "m");
+  duk_put_prop_string(ctx_, -2, "prototype");
+  duk_put_prop_string(ctx_, -2, "B");
+
+  duk::put_prop_function<duk::ctor<A>>(ctx_, -1, "makeA");
+
+  duk_pop(ctx_); // Pop global object
+
+  duk_peval_string(ctx_, "f(makeA(), 10)");
+  REQUIRE(duk::get<int>(ctx_, -1) == 10);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "f(makeA(), new B())");
+  REQUIRE(duk::get<int>(ctx_, -1) == 3);
+  duk_pop(ctx_);
+
+  duk_peval_string(ctx_, "new B().m(makeA())");
+  REQUIRE(duk::get<int>(ctx_, -1) == 201);
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "f(new B(), makeA())") != 0); // Call failed with an error.
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "f({}, 10)") != 0); // Call failed with an error.
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Overload dispatch")
+{
+  // Overloads are grouped by argument count and filtered by argument types before any of them is tried. Make sure
+  // this doesn't change which overload gets picked.
+  static constexpr auto f0 = []() { return 0; };
+  static constexpr auto fInt = [](int) { return 1; };
+  static constexpr auto fDouble = [](double) { return 2; }; // Never picked, fInt comes first.
+  static constexpr auto fString = [](std::string) { return 3; };
+  static constexpr auto fBool = [](bool) { return 4; };
+  static constexpr auto fVector = [](const Vector&) { return 5; };
+  static constexpr auto fIntString = [](int, std::string) { return 6; };
+  static constexpr auto fStringInt = [](std::string, int) { return 7; };
+
+  duk_push_global_object(ctx_);
+
+  registerVector(ctx_, -1);
+
+  duk::put_prop_function<
+    fIntString, fStringInt, fVector, fBool, fString, fInt, fDouble, f0
+  >(ctx_, -1, "f");
+
+  duk_pop(ctx_); // Pop global object
+
+  const auto call = [this](const char* code)
+  {
+    REQUIRE(duk_peval_string(ctx_, code) == 0);
+    auto result = duk::get<int>(ctx_, -1);
+    duk_pop(ctx_);
+
+    return result;
+  };
+
+  REQUIRE(call("f()") == 0);
+  REQUIRE(call("f(1)") == 1);
+  REQUIRE(call("f('s')") == 3);
+  REQUIRE(call("f(true)") == 4);
+  REQUIRE(call("f(new Vector(1, 2))") == 5);
+  REQUIRE(call("f(1, 's')") == 6);
+  REQUIRE(call("f('s', 1)") == 7);
+
+  REQUIRE(duk_peval_string(ctx_, "f({})") != 0); // Call failed with an error.
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "f(1, 2)") != 0);
+  duk_pop(ctx_);
+
+  REQUIRE(duk_peval_string(ctx_, "f(1, 's', 2)") != 0);
+  duk_pop(ctx_);
+}
+
+
+TEST_CASE_METHOD(DukCppTest, "Inline object storage")
+{
+  static constexpr auto length = [](const Vector& v) { return v.length(); };
+
+  duk_push_global_object(ctx_);
+
+  duk::put_prop_function<duk::ctor<InlineVector, float, float>>(ctx_, -1, "makeVector");
+  duk::put_prop_function<length>(ctx_, -1, "length");
+
+  duk_pop(ctx_); // Pop global object
+
+  duk_peval_string(ctx_, R"__(
+    var v = makeVector(3, 4);
+    length(v);
+  )__");
+  REQUIRE(equals(duk::get<float>(ctx_, -1), 5.0f, 1e-5f));
+  duk_pop(ctx_);
+
+  duk_get_global_string(ctx_, "v");
+  REQUIRE(duk::get<InlineVector>(ctx_, -1) == Vector(3, 4));
+
+  REQUIRE(duk::clone(ctx_, -1));
+  REQUIRE(duk::get<InlineVector>(ctx_, -1) == Vector(3, 4));
+
+  REQUIRE(duk::finalize(ctx_, -1));
+  REQUIRE_THROWS_AS(duk::get<InlineVector>(ctx_, -1), duk::error);
+
+  // Finalizing the clone leaves the original intact.
+  REQUIRE(duk::get<InlineVector>(ctx_, -2) == Vector(3, 4));
+
+  duk_pop_2(ctx_);
+}
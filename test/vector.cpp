@@ -85,6 +85,8 @@ void* registerVector(duk_context* ctx, duk_idx_t idx)
 
   auto prototypeHandle = duk_get_heapptr(ctx, -1);
 
+  duk::register_prototype<Vector>(ctx, -1);
+
   duk::put_prop_function<
     static_cast<void(Vector::*)(float)>(&Vector::add),
     static_cast<void(Vector::*)(const Vector&)>(&Vector::add)
@@ -110,7 +112,33 @@ void* registerVector(duk_context* ctx, duk_idx_t idx)
     static_cast<Vector(*)(const Vector&, const Vector&)>(&operator+)
   >(ctx, idx, "addVector");
 
-  duk::class_traits_prototype<Vector>::heap_ptr = prototypeHandle;
-
   return prototypeHandle;
 }
+
+
+void* registerVectorClass(duk_context* ctx, duk_idx_t idx)
+{
+  duk::class_<Vector,
+    duk::constructor<
+      duk::ctor<Vector>,
+      duk::ctor<Vector, float, float>
+    >,
+    duk::method<"add",
+      static_cast<void(Vector::*)(float)>(&Vector::add),
+      static_cast<void(Vector::*)(const Vector&)>(&Vector::add)
+    >,
+    duk::method<"sub",
+      &Vector::operator-,
+      static_cast<Vector(*)(const Vector&, float)>(&operator-)
+    >,
+    duk::property<"x", &Vector::x>,
+    duk::property<"y", &Vector::y>,
+    duk::method<"length", &Vector::length>
+  >::put_prop(ctx, idx, "Vector");
+
+  duk::put_prop_function<
+    static_cast<Vector(*)(const Vector&, const Vector&)>(&operator+)
+  >(ctx, idx, "addVector");
+
+  return duk::get_prototype<Vector>(ctx);
+}
@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include <duk/class.h>
+#include <type_traits>
 
 
 struct Vector
@@ -32,8 +33,38 @@ struct Vector
 };
 
 
+// Same as Vector, but stored inline, in a Duktape-owned buffer.
+struct InlineVector : Vector
+{
+  using Vector::Vector;
+};
+
+
+namespace duk
+{
+
+
+template<>
+struct class_traits_base<InlineVector>
+{
+  using type = Vector;
+};
+
+
+template<>
+struct class_traits_inline_storage<InlineVector> : std::true_type
+{
+};
+
+
+} // namespace duk
+
+
 // Returns prototype object handle
 void* registerVector(duk_context* ctx, duk_idx_t idx);
 
+// Same bindings as registerVector, declared with duk::class_
+void* registerVectorClass(duk_context* ctx, duk_idx_t idx);
+
 
 #endif // DUKCPP_TEST_VECTOR_H